@@ -0,0 +1,599 @@
+#ifndef TET_CUT_ASYNC_CUT_HPP
+#define TET_CUT_ASYNC_CUT_HPP
+
+#include "attribute_transfer.hpp"
+#include "cut_journal.hpp"
+#include "cut_tetrahedron.hpp"
+#include "mesh_primitives.hpp"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <future>
+#include <igl/parallel_for.h>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Mesh published by an asynchronous cutter. F holds the boundary faces oriented for rendering
+ * and A the per-vertex attributes. Published buffers are never modified, such that readers may
+ * use them for as long as they hold them.
+ */
+struct mesh_buffer_t
+{
+    Eigen::MatrixXd V{};
+    Eigen::MatrixXi T{};
+    Eigen::MatrixXi F{};
+    Eigen::MatrixXd A{};
+    std::uint64_t version{0u};
+};
+
+struct async_cut_result_t
+{
+    int cut_tetrahedron_count{0};
+    int new_vertex_count{0};
+    int new_tetrahedron_count{0};
+    std::vector<cut_surface_triangle_t> cut_surface{};
+    // quality of the tetrahedra produced by the cut, if measured
+    tetrahedron_quality_t quality{};
+    // version of the published buffer that first holds this cut
+    std::uint64_t version{0u};
+};
+
+namespace detail {
+
+/**
+ * @brief
+ * Blocking first-in first-out queue connecting two pipeline stages. pop returns no job once the
+ * queue is closed and drained.
+ */
+template <class Job>
+class job_queue_t
+{
+  public:
+    void push(Job job)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            jobs_.push_back(std::move(job));
+        }
+        condition_.notify_one();
+    }
+
+    std::optional<Job> pop()
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        condition_.wait(lock, [this]() { return is_closed_ || !jobs_.empty(); });
+        if (jobs_.empty())
+            return std::nullopt;
+
+        Job job = std::move(jobs_.front());
+        jobs_.pop_front();
+        return job;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            is_closed_ = true;
+        }
+        condition_.notify_all();
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<Job> jobs_;
+    bool is_closed_{false};
+};
+
+/**
+ * @brief
+ * Rows of an array changed by each of its recent versions, from which a copy of an older version
+ * is brought up to date by copying only the rows changed since, together with the rows appended
+ * since. Versions must be recorded in increasing order, and a gap restarts the log.
+ */
+class row_change_log_t
+{
+  public:
+    static std::size_t constexpr max_version_count = 64u;
+
+    void record(std::uint64_t version, std::vector<int> rows)
+    {
+        if (versions_.empty() || version != first_version_ + versions_.size())
+        {
+            versions_.clear();
+            first_version_ = version;
+        }
+
+        versions_.push_back(std::move(rows));
+        if (versions_.size() > max_version_count)
+        {
+            versions_.pop_front();
+            ++first_version_;
+        }
+    }
+
+    void clear() { versions_.clear(); }
+
+    /**
+     * @brief
+     * Appends the rows changed by the versions after version to rows
+     * @return False if these versions are not all logged
+     */
+    bool changed_since(std::uint64_t version, std::vector<int>& rows) const
+    {
+        if (versions_.empty() || version + 1u < first_version_ ||
+            version >= first_version_ + versions_.size())
+            return false;
+
+        for (std::size_t i = version + 1u - first_version_; i < versions_.size(); ++i)
+            rows.insert(rows.end(), versions_[i].begin(), versions_[i].end());
+        return true;
+    }
+
+  private:
+    std::deque<std::vector<int>> versions_{};
+    std::uint64_t first_version_{0u};
+};
+
+/**
+ * @brief
+ * Brings copy, a copy of an older version of source, up to date with source by copying the rows
+ * of source appended since and the given changed rows, or all rows if is_logged is false
+ */
+template <class Source, class Copy>
+void update_rows(
+    Source const& source,
+    Copy& copy,
+    std::vector<int> const& changed_rows,
+    bool is_logged)
+{
+    Eigen::Index const copied_rows = is_logged ? copy.rows() : 0;
+    copy.conservativeResize(source.rows(), source.cols());
+    for (int const row : changed_rows)
+        if (row < std::min(copied_rows, source.rows()))
+            copy.row(row) = source.row(row);
+    for (Eigen::Index row = copied_rows; row < source.rows(); ++row)
+        copy.row(row) = source.row(row);
+}
+
+} // namespace detail
+
+/**
+ * @brief
+ * Cuts a mesh in the background such that interactive applications never wait for a cut. A
+ * submitted cut returns a future immediately and goes through two pipeline stages running on
+ * their own threads:
+ *
+ * 1. classification of the candidate tetrahedra, in parallel, followed by their subdivision on
+ *    the cutter's working mesh, which is then copied into a back buffer,
+ * 2. generation of the back buffer's boundary faces and transfer of the attributes onto the new
+ *    vertices, after which the back buffer is published.
+ *
+ * Consecutive cuts overlap, i.e. the next cut is subdivided while the previous one is finalized.
+ * Readers obtain the latest published buffer through front(), which only swaps a shared pointer
+ * and therefore takes constant time regardless of the size of the cuts in flight. Buffers that
+ * readers have released are reused as back buffers.
+ *
+ * A reused back buffer is brought up to date by copying only the rows of T and F changed by the
+ * cuts since its version, and the rows of V and A appended since, and the boundary faces are
+ * patched from the faces of the changed tetrahedra. Growing the buffer's Eigen matrices still
+ * reallocates them, which is a plain copy of the mesh's memory, and the culling of candidate
+ * tetrahedra tests the bounding box of every tetrahedron.
+ */
+class async_mesh_cutter_t
+{
+  public:
+    /**
+     * @brief
+     * @param V Vertex positions
+     * @param T Tetrahedra
+     * @param A Per-vertex attributes, empty if there are none
+     * @param parameters Cutter whose snapping, fracture and quality parameters are used
+     */
+    async_mesh_cutter_t(
+        Eigen::MatrixXd V,
+        Eigen::MatrixXi T,
+        Eigen::MatrixXd A                           = {},
+        tetrahedron_mesh_cutter_t const& parameters = {})
+        : V_{std::move(V)}, T_{std::move(T)}, A_{std::move(A)}
+    {
+        cutter_.snapping        = parameters.snapping;
+        cutter_.measure_quality = parameters.measure_quality;
+        cutter_.fracture        = parameters.fracture;
+        cutter_.vertex_sources  = &vertex_sources_;
+        cutter_.cut_surface     = &cut_surface_;
+        cutter_.delta           = &delta_;
+
+        auto buffer = std::make_shared<mesh_buffer_t>();
+        buffer->V   = V_;
+        buffer->T   = T_;
+        buffer->A   = A_;
+        build_boundary(buffer->T);
+        copy_boundary(buffer->F, {}, false);
+        std::atomic_store(&front_, std::move(buffer));
+
+        subdivision_thread_  = std::thread([this]() { run_subdivision_stage(); });
+        finalization_thread_ = std::thread([this]() { run_finalization_stage(); });
+    }
+
+    async_mesh_cutter_t(async_mesh_cutter_t const&) = delete;
+    async_mesh_cutter_t& operator=(async_mesh_cutter_t const&) = delete;
+
+    /**
+     * @brief
+     * Completes the cuts that were submitted and joins the stage threads
+     */
+    ~async_mesh_cutter_t()
+    {
+        subdivision_jobs_.close();
+        subdivision_thread_.join();
+        finalization_jobs_.close();
+        finalization_thread_.join();
+    }
+
+    /**
+     * @brief
+     * Submits a cut of the mesh by the triangle formed by start_line and end_line. Cuts are
+     * applied in submission order.
+     * @return Future holding the cut's result once its buffer is published
+     */
+    std::future<async_cut_result_t> submit(
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line)
+    {
+        subdivision_job_t job{start_line, end_line, {}};
+        auto future = job.promise.get_future();
+        subdivision_jobs_.push(std::move(job));
+        return future;
+    }
+
+    /**
+     * @brief
+     * @return Latest published mesh
+     */
+    std::shared_ptr<mesh_buffer_t const> front() const { return std::atomic_load(&front_); }
+
+  private:
+    struct subdivision_job_t
+    {
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> start_line;
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> end_line;
+        std::promise<async_cut_result_t> promise;
+    };
+
+    struct finalization_job_t
+    {
+        std::shared_ptr<mesh_buffer_t> buffer;
+        // version the buffer held before it was brought up to date with this cut
+        std::uint64_t buffer_version;
+        std::uint64_t version;
+        std::vector<vertex_source_t> vertex_sources;
+        // rows of T overwritten by the cut and the tetrahedra they held, and the first appended row
+        std::vector<int> removed_tetrahedra;
+        std::vector<Eigen::RowVector4i> replaced_tetrahedra;
+        int first_appended_tetrahedron;
+        // whether a failed cut left changes that are not in removed_tetrahedra
+        bool is_unlogged;
+        async_cut_result_t result;
+        std::promise<async_cut_result_t> promise;
+    };
+
+    // faces of the rows of T with the same sorted vertices, counted per orientation
+    struct boundary_face_t
+    {
+        // faces whose vertices are an even, resp. odd, permutation of the key
+        std::array<int, 2u> counts{0, 0};
+        // index into boundary_ of the face, or -1 if it is not a boundary face
+        int row{-1};
+    };
+
+    using boundary_face_map_t =
+        std::unordered_map<std::array<int, 3u>, boundary_face_t, detail::indices_hash_t>;
+
+    void run_subdivision_stage()
+    {
+        while (auto job = subdivision_jobs_.pop())
+        {
+            try
+            {
+                finalization_jobs_.push(subdivide(*job));
+            }
+            catch (...)
+            {
+                // the working mesh may hold rows the logs do not know of
+                changed_tetrahedra_.clear();
+                is_unlogged_ = true;
+                job->promise.set_exception(std::current_exception());
+            }
+        }
+    }
+
+    void run_finalization_stage()
+    {
+        while (auto job = finalization_jobs_.pop())
+        {
+            try
+            {
+                auto& buffer = *job->buffer;
+                transfer_attributes(job->vertex_sources, A_);
+                detail::update_rows(A_, buffer.A, {}, true);
+                finalize(*job);
+
+                job->result.version = buffer.version = job->version;
+                release(std::atomic_exchange(&front_, std::move(job->buffer)));
+
+                job->promise.set_value(std::move(job->result));
+            }
+            catch (...)
+            {
+                // the boundary may be partially patched, so it is rebuilt by the next cut
+                is_boundary_valid_ = false;
+                changed_faces_.clear();
+                job->promise.set_exception(std::current_exception());
+            }
+        }
+    }
+
+    finalization_job_t subdivide(subdivision_job_t& job)
+    {
+        auto const& start_line = job.start_line;
+        auto const& end_line   = job.end_line;
+
+        Eigen::Vector3d const min =
+            start_line.first.cwiseMin(start_line.second).cwiseMin(end_line.second);
+        Eigen::Vector3d const max =
+            start_line.first.cwiseMax(start_line.second).cwiseMax(end_line.second);
+
+        int const vertex_count      = static_cast<int>(V_.rows());
+        int const tetrahedron_count = static_cast<int>(T_.rows());
+
+        overlaps_.resize(static_cast<std::size_t>(tetrahedron_count));
+        igl::parallel_for(
+            tetrahedron_count,
+            [&](int t) {
+                Eigen::RowVector3d tmin = V_.row(T_(t, 0));
+                Eigen::RowVector3d tmax = tmin;
+                for (int j = 1; j < 4; ++j)
+                {
+                    tmin = tmin.cwiseMin(V_.row(T_(t, j)));
+                    tmax = tmax.cwiseMax(V_.row(T_(t, j)));
+                }
+
+                overlaps_[t] = (tmin.transpose().array() <= max.array()).all() &&
+                               (tmax.transpose().array() >= min.array()).all();
+            },
+            1000u);
+
+        vertex_sources_.clear();
+        cut_surface_.clear();
+        delta_.clear();
+        cutter_.quality = {};
+
+        finalization_job_t next{};
+        next.version = ++subdivided_version_;
+        cutter_.begin_cut();
+        for (int t = 0; t < tetrahedron_count; ++t)
+        {
+            if (overlaps_[t] != 0u && cut_tetrahedron(cutter_, V_, T_, t, start_line, end_line))
+                ++next.result.cut_tetrahedron_count;
+        }
+        cutter_.end_cut();
+        changed_tetrahedra_.record(next.version, delta_.removed_tetrahedra());
+
+        next.result.new_vertex_count      = static_cast<int>(V_.rows()) - vertex_count;
+        next.result.new_tetrahedron_count = static_cast<int>(T_.rows()) - tetrahedron_count;
+        next.result.cut_surface           = cut_surface_;
+        next.result.quality               = cutter_.quality;
+        next.vertex_sources               = vertex_sources_;
+        next.removed_tetrahedra           = delta_.removed_tetrahedra();
+        next.replaced_tetrahedra          = delta_.replaced_tetrahedra();
+        next.first_appended_tetrahedron   = tetrahedron_count;
+        next.is_unlogged                  = is_unlogged_;
+        is_unlogged_                      = false;
+
+        next.buffer         = acquire();
+        next.buffer_version = next.buffer->version;
+
+        std::vector<int> changed_rows{};
+        bool const is_logged = changed_tetrahedra_.changed_since(next.buffer_version, changed_rows);
+        detail::update_rows(V_, next.buffer->V, {}, true);
+        detail::update_rows(T_, next.buffer->T, changed_rows, is_logged);
+
+        next.promise = std::move(job.promise);
+        return next;
+    }
+
+    /**
+     * @brief
+     * Patches the boundary faces with the faces of the tetrahedra the job's cut removed and added,
+     * and brings the job's buffer's boundary faces up to date
+     */
+    void finalize(finalization_job_t& job)
+    {
+        auto& buffer = *job.buffer;
+        std::vector<int> changed_rows{};
+        if (!is_boundary_valid_ || job.is_unlogged)
+        {
+            build_boundary(buffer.T);
+        }
+        else
+        {
+            for (auto const& tetrahedron : job.replaced_tetrahedra)
+                update_boundary(tetrahedron, -1, changed_rows);
+            for (int const t : job.removed_tetrahedra)
+                update_boundary(buffer.T.row(t), 1, changed_rows);
+            for (int t = job.first_appended_tetrahedron; t < buffer.T.rows(); ++t)
+                update_boundary(buffer.T.row(t), 1, changed_rows);
+        }
+        changed_faces_.record(job.version, std::move(changed_rows));
+
+        changed_rows.clear();
+        bool const is_logged = changed_faces_.changed_since(job.buffer_version, changed_rows);
+        copy_boundary(buffer.F, changed_rows, is_logged);
+    }
+
+    // same as detail::update_rows, from the boundary faces, which may also have lost rows
+    void copy_boundary(Eigen::MatrixXi& F, std::vector<int> const& changed_rows, bool is_logged)
+    {
+        int const face_count  = static_cast<int>(boundary_.size());
+        int const copied_rows = is_logged ? std::min(static_cast<int>(F.rows()), face_count) : 0;
+        F.conservativeResize(face_count, 3);
+
+        auto const copy_row = [&](int row) {
+            F.row(row) << boundary_[row][0], boundary_[row][1], boundary_[row][2];
+        };
+        for (int const row : changed_rows)
+            if (row < copied_rows)
+                copy_row(row);
+        for (int row = copied_rows; row < face_count; ++row)
+            copy_row(row);
+    }
+
+    void build_boundary(Eigen::MatrixXi const& T)
+    {
+        boundary_faces_.clear();
+        boundary_.clear();
+        std::vector<int> changed_rows{};
+        for (int t = 0; t < T.rows(); ++t)
+            update_boundary(T.row(t), 1, changed_rows);
+        changed_faces_.clear();
+        is_boundary_valid_ = true;
+    }
+
+    /**
+     * @brief
+     * Adds (count = 1) or removes (count = -1) the faces of a tetrahedron, which are boundary
+     * faces when no other tetrahedron has them, oriented outwards of the tetrahedron as by
+     * reversing the faces of igl::boundary_facets. Rows of boundary_ whose face changed are
+     * appended to changed_rows.
+     */
+    void update_boundary(
+        Eigen::RowVector4i const& tetrahedron,
+        int count,
+        std::vector<int>& changed_rows)
+    {
+        std::array<std::array<int, 3u>, 4u> constexpr TF{
+            {{0, 1, 3}, {1, 2, 3}, {2, 0, 3}, {0, 2, 1}}};
+
+        for (auto const& f : TF)
+        {
+            std::array<int, 3u> key{tetrahedron(f[0]), tetrahedron(f[1]), tetrahedron(f[2])};
+            int const parity = detail::sort_face(key);
+
+            auto& face = boundary_faces_[key];
+            face.counts[parity] += count;
+
+            if (face.counts[0] + face.counts[1] == 1)
+            {
+                std::array<int, 3u> oriented = key;
+                if (face.counts[1] == 1)
+                    std::swap(oriented[1], oriented[2]);
+                if (face.row < 0)
+                {
+                    face.row = static_cast<int>(boundary_.size());
+                    boundary_.push_back(oriented);
+                    changed_rows.push_back(face.row);
+                }
+                else if (boundary_[face.row] != oriented)
+                {
+                    boundary_[face.row] = oriented;
+                    changed_rows.push_back(face.row);
+                }
+            }
+            else if (face.row >= 0)
+            {
+                // the last boundary face fills the removed face's row
+                int const last = static_cast<int>(boundary_.size()) - 1;
+                if (face.row != last)
+                {
+                    std::array<int, 3u> moved = boundary_[last];
+                    detail::sort_face(moved);
+                    boundary_faces_[moved].row = face.row;
+                    boundary_[face.row]        = boundary_[last];
+                    changed_rows.push_back(face.row);
+                }
+                boundary_.pop_back();
+                face.row = -1;
+            }
+
+            if (face.counts[0] == 0 && face.counts[1] == 0)
+                boundary_faces_.erase(key);
+        }
+    }
+
+    std::shared_ptr<mesh_buffer_t> acquire()
+    {
+        std::lock_guard<std::mutex> lock{spare_buffers_mutex_};
+        for (auto it = spare_buffers_.begin(); it != spare_buffers_.end(); ++it)
+        {
+            if (it->use_count() == 1)
+            {
+                auto buffer = std::move(*it);
+                spare_buffers_.erase(it);
+                return buffer;
+            }
+        }
+
+        // an empty buffer is brought up to date by copying all rows
+        auto buffer     = std::make_shared<mesh_buffer_t>();
+        buffer->version = std::numeric_limits<std::uint64_t>::max();
+        return buffer;
+    }
+
+    void release(std::shared_ptr<mesh_buffer_t> buffer)
+    {
+        std::lock_guard<std::mutex> lock{spare_buffers_mutex_};
+        // a reader may still hold the buffer, in which case it is only reused once released
+        if (spare_buffers_.size() < 2u)
+            spare_buffers_.push_back(std::move(buffer));
+    }
+
+    // working mesh, owned by the subdivision stage
+    Eigen::MatrixXd V_;
+    Eigen::MatrixXi T_;
+    tetrahedron_mesh_cutter_t cutter_{};
+    std::vector<std::uint8_t> overlaps_{};
+    std::vector<vertex_source_t> vertex_sources_{};
+    std::vector<cut_surface_triangle_t> cut_surface_{};
+    cut_delta_t delta_{};
+    std::uint64_t subdivided_version_{0u};
+    detail::row_change_log_t changed_tetrahedra_{};
+    bool is_unlogged_{false};
+
+    // working attributes and boundary faces, owned by the finalization stage
+    Eigen::MatrixXd A_;
+    std::vector<std::array<int, 3u>> boundary_{};
+    boundary_face_map_t boundary_faces_{};
+    bool is_boundary_valid_{true};
+    detail::row_change_log_t changed_faces_{};
+
+    std::shared_ptr<mesh_buffer_t> front_{};
+    std::mutex spare_buffers_mutex_{};
+    std::vector<std::shared_ptr<mesh_buffer_t>> spare_buffers_{};
+
+    detail::job_queue_t<subdivision_job_t> subdivision_jobs_{};
+    detail::job_queue_t<finalization_job_t> finalization_jobs_{};
+    std::thread subdivision_thread_{};
+    std::thread finalization_thread_{};
+};
+
+} // namespace geometry
+
+#endif // TET_CUT_ASYNC_CUT_HPP
@@ -0,0 +1,66 @@
+#ifndef TET_CUT_ATTRIBUTE_TRANSFER_HPP
+#define TET_CUT_ATTRIBUTE_TRANSFER_HPP
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Source of a vertex created by a cut. The vertex interpolates up to three existing mesh vertices
+ * (-1 if unused) with the given weights, i.e. the endpoints of an intersected edge with weights
+ * (1-t, t) or the vertices of an intersected face with its barycentric coordinates. A fracture
+ * copy has the same parents and weights as the vertex it copies, which copied_vertex holds.
+ */
+struct vertex_source_t
+{
+    int vertex;
+    std::array<int, 3u> vertices;
+    std::array<double, 3u> weights;
+    int copied_vertex = -1;
+
+    bool is_copy() const { return copied_vertex >= 0; }
+};
+
+/**
+ * @brief
+ * Interpolates per-vertex attributes (one row per vertex, any number of columns) onto the
+ * vertices created by cuts. A is grown to hold the new vertices if necessary. Sources must be in
+ * creation order, such that vertices created by earlier cuts are filled in before they are
+ * interpolated by later ones.
+ * @param sources Vertex sources recorded by the cutter
+ * @param A Per-vertex attributes
+ */
+template <class DerivedA>
+void transfer_attributes(
+    std::vector<vertex_source_t> const& sources,
+    Eigen::PlainObjectBase<DerivedA>& A)
+{
+    using scalar_type = typename DerivedA::Scalar;
+
+    Eigen::Index vertex_count = A.rows();
+    for (auto const& source : sources)
+        vertex_count = std::max<Eigen::Index>(vertex_count, source.vertex + 1);
+
+    A.conservativeResize(vertex_count, Eigen::NoChange);
+
+    for (auto const& source : sources)
+    {
+        A.row(source.vertex).setZero();
+        for (int i = 0; i < 3; ++i)
+        {
+            if (source.vertices[i] < 0)
+                continue;
+
+            A.row(source.vertex) += static_cast<scalar_type>(source.weights[i]) *
+                                    A.row(source.vertices[i]);
+        }
+    }
+}
+
+} // namespace geometry
+
+#endif // TET_CUT_ATTRIBUTE_TRANSFER_HPP
@@ -0,0 +1,101 @@
+#ifndef TET_CUT_BATCH_CUT_HPP
+#define TET_CUT_BATCH_CUT_HPP
+
+#include "cut_tetrahedron.hpp"
+#include "thread_pool.hpp"
+
+#include <Eigen/Core>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Cut of an independent tetrahedral mesh by a cutting triangle. Optional per-job journal and
+ * vertex source outputs are owned by the caller.
+ */
+struct cut_job_t
+{
+    Eigen::MatrixXd* V;
+    Eigen::MatrixXi* T;
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> start_line;
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> end_line;
+    cut_journal_t* journal{nullptr};
+    std::vector<vertex_source_t>* vertex_sources{nullptr};
+};
+
+struct cut_job_result_t
+{
+    int cut_tetrahedron_count{0};
+    int new_vertex_count{0};
+    int new_tetrahedron_count{0};
+    // quality of the tetrahedra produced by the job's cut, if measured
+    tetrahedron_quality_t quality{};
+};
+
+/**
+ * @brief
+ * Cuts batches of many small independent meshes concurrently, one job per mesh, on a
+ * work-stealing thread pool. Every worker owns a cutter whose scratch buffers are reused across
+ * jobs and batches.
+ */
+class batch_mesh_cutter_t
+{
+  public:
+    /**
+     * @brief
+     * @param thread_count Number of worker threads
+     * @param parameters Cutter whose snapping and quality measurement parameters are used by all
+     * workers
+     */
+    explicit batch_mesh_cutter_t(
+        std::size_t thread_count = std::max(1u, std::thread::hardware_concurrency()),
+        tetrahedron_mesh_cutter_t const& parameters = {})
+        : pool_{thread_count}, cutters_(pool_.thread_count())
+    {
+        for (auto& cutter : cutters_)
+        {
+            cutter.snapping        = parameters.snapping;
+            cutter.measure_quality = parameters.measure_quality;
+        }
+    }
+
+    /**
+     * @brief
+     * Cuts the meshes of all jobs and blocks until they are done
+     * @return Results in job order
+     */
+    std::vector<cut_job_result_t> cut(std::vector<cut_job_t> const& jobs)
+    {
+        std::vector<cut_job_result_t> results(jobs.size());
+        pool_.run(jobs.size(), [&](std::size_t j, std::size_t worker) {
+            auto const& job = jobs[j];
+            auto& cutter    = cutters_[worker];
+
+            cutter.journal        = job.journal;
+            cutter.vertex_sources = job.vertex_sources;
+
+            int const vertex_count      = static_cast<int>(job.V->rows());
+            int const tetrahedron_count = static_cast<int>(job.T->rows());
+
+            auto& result = results[j];
+            result.cut_tetrahedron_count =
+                cut_mesh(cutter, *job.V, *job.T, job.start_line, job.end_line);
+            result.new_vertex_count      = static_cast<int>(job.V->rows()) - vertex_count;
+            result.new_tetrahedron_count = static_cast<int>(job.T->rows()) - tetrahedron_count;
+            result.quality               = cutter.quality;
+        });
+        return results;
+    }
+
+    std::size_t thread_count() const { return pool_.thread_count(); }
+
+  private:
+    work_stealing_thread_pool_t pool_;
+    std::vector<tetrahedron_mesh_cutter_t> cutters_;
+};
+
+} // namespace geometry
+
+#endif // TET_CUT_BATCH_CUT_HPP
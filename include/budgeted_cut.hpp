@@ -0,0 +1,419 @@
+#ifndef TET_CUT_BUDGETED_CUT_HPP
+#define TET_CUT_BUDGETED_CUT_HPP
+
+#include "mesh_storage.hpp"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Histogram of latencies with logarithmic buckets, four per power of two of nanoseconds, such
+ * that percentiles are reported within 25% of the recorded latencies
+ */
+class latency_histogram_t
+{
+  public:
+    static int constexpr bucket_count = 252;
+
+    void record(std::chrono::nanoseconds latency)
+    {
+        auto const ns = static_cast<std::uint64_t>(std::max<std::int64_t>(latency.count(), 0));
+        ++buckets_[bucket(ns)];
+        ++count_;
+        total_ += ns;
+        max_ = std::max(max_, ns);
+    }
+
+    void merge(latency_histogram_t const& other)
+    {
+        for (int i = 0; i < bucket_count; ++i)
+            buckets_[i] += other.buckets_[i];
+        count_ += other.count_;
+        total_ += other.total_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    void clear() { *this = latency_histogram_t{}; }
+
+    std::uint64_t count() const { return count_; }
+    std::chrono::nanoseconds max() const { return std::chrono::nanoseconds(max_); }
+    std::chrono::nanoseconds mean() const
+    {
+        return std::chrono::nanoseconds(count_ > 0u ? total_ / count_ : 0u);
+    }
+
+    /**
+     * @brief
+     * Upper bound of the latencies of the fraction p of recorded calls, e.g. p = 0.99 for the
+     * 99th percentile
+     */
+    std::chrono::nanoseconds percentile(double p) const
+    {
+        auto const target =
+            static_cast<std::uint64_t>(std::ceil(p * static_cast<double>(count_)));
+        std::uint64_t cumulative = 0u;
+        for (int i = 0; i < bucket_count; ++i)
+        {
+            cumulative += buckets_[i];
+            if (cumulative >= std::max<std::uint64_t>(target, 1u))
+                return std::chrono::nanoseconds(std::min(upper_bound(i), max_));
+        }
+        return max();
+    }
+
+    /**
+     * @brief
+     * Number of recorded calls in bucket i, whose latencies are in [lower_bound(i),
+     * upper_bound(i)) nanoseconds
+     */
+    std::uint64_t bucket_size(int i) const { return buckets_[i]; }
+
+    static std::uint64_t lower_bound(int i)
+    {
+        if (i < 4)
+            return static_cast<std::uint64_t>(i);
+        return (4u + static_cast<std::uint64_t>(i % 4)) << (i / 4 - 1);
+    }
+
+    static std::uint64_t upper_bound(int i)
+    {
+        if (i < 4)
+            return static_cast<std::uint64_t>(i) + 1u;
+        return (5u + static_cast<std::uint64_t>(i % 4)) << (i / 4 - 1);
+    }
+
+  private:
+    static int bucket(std::uint64_t ns)
+    {
+        if (ns < 4u)
+            return static_cast<int>(ns);
+
+        int exponent = 2;
+        while ((ns >> (exponent + 1)) != 0u)
+            ++exponent;
+        return 4 * (exponent - 1) + static_cast<int>((ns >> (exponent - 2)) & 3u);
+    }
+
+    std::array<std::uint64_t, bucket_count> buckets_{};
+    std::uint64_t count_{0u};
+    std::uint64_t total_{0u};
+    std::uint64_t max_{0u};
+};
+
+/**
+ * @brief
+ * Cut of a mesh accessed through mesh_traits by the triangle formed by start_line and end_line,
+ * performed in steps of bounded duration, e.g. one per iteration of a haptic loop. The first
+ * steps find the candidate tetrahedra in blocks, which are then cut in order of distance to
+ * end_line, i.e. to the blade's current position, such that the tetrahedra the blade touches are
+ * cut first.
+ *
+ * Every step subdivides candidates in local copies until its budget is spent, predicted from
+ * the running cost of previous subdivisions, and then writes them into the mesh with a single
+ * append. The cut runs between the cutter's begin_cut and end_cut, such that subdivisions share
+ * the vertices of crossed edges and faces with the neighbours cut before, in earlier steps or
+ * earlier in the same step, and the mesh is conforming once the cut is done. At every yield
+ * point, the mesh holds whole subdivisions only, exactly as after the corresponding sequence of
+ * cut_tetrahedron calls, and can be used, deformed or rendered until the cut is resumed. It is
+ * not conforming there, however: a crossed edge whose incident tetrahedra are only partly cut
+ * holds a vertex that the others do not refer to yet. Changing the mesh's topology, or using the
+ * cutter for other cuts, while a cut is pending is not supported.
+ *
+ * Appending to eigen_mesh_t copies the whole mesh, which bounds a step's latency from below.
+ * Storage with spare capacity, e.g. mapped_mesh_t or vector_mesh_t with reserved vectors, keeps
+ * the latency of a step close to its budget.
+ */
+template <class Mesh>
+class resumable_cut_t
+{
+  public:
+    using clock_type = std::chrono::steady_clock;
+
+    resumable_cut_t(
+        tetrahedron_mesh_cutter_t& cutter,
+        Mesh& mesh,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line)
+        : cutter_{cutter},
+          mesh_{mesh},
+          start_line_{start_line},
+          end_line_{end_line},
+          tetrahedron_count_{mesh_traits<Mesh>::tetrahedron_count(mesh)}
+    {
+        cutter_.quality = {};
+        cutter_.begin_cut();
+    }
+
+    bool done() const { return phase_ == phase_t::done; }
+
+    // true if the last step could not append its rows to the mesh's storage
+    bool is_blocked() const { return is_blocked_; }
+
+    int cut_count() const { return cut_count_; }
+    int remaining_count() const
+    {
+        return phase_ == phase_t::cutting ? static_cast<int>(candidates_.size()) - next_candidate_ :
+                                            0;
+    }
+
+    // latencies of all steps of this cut
+    latency_histogram_t const& latencies() const { return latencies_; }
+
+    /**
+     * @brief
+     * Continues the cut for at most budget, and at most max_tetrahedra intersection tests of
+     * candidate tetrahedra. At least one candidate is tested per step, such that the cut
+     * progresses with budgets below the cost of a single subdivision. If the mesh's storage
+     * cannot hold the rows of the step, the step is undone and is_blocked is set.
+     * @return True if the cut is complete
+     */
+    bool step(
+        std::chrono::nanoseconds budget,
+        int max_tetrahedra = std::numeric_limits<int>::max())
+    {
+        auto const begin    = clock_type::now();
+        auto const deadline = begin + budget;
+
+        bool const is_scanning = phase_ == phase_t::scanning;
+        if (is_scanning)
+            scan(deadline);
+
+        // a step that finished scanning only cuts if it has budget left
+        if (phase_ == phase_t::cutting && (!is_scanning || clock_type::now() < deadline))
+            cut(deadline, max_tetrahedra);
+
+        latencies_.record(clock_type::now() - begin);
+        return done();
+    }
+
+  private:
+    using traits = mesh_traits<Mesh>;
+
+    enum class phase_t
+    {
+        scanning,
+        cutting,
+        done
+    };
+
+    static int constexpr scan_block_size = 1 << 12;
+
+    void scan(clock_type::time_point deadline)
+    {
+        Eigen::RowVector3d const min =
+            start_line_.first.cwiseMin(start_line_.second).cwiseMin(end_line_.second).transpose();
+        Eigen::RowVector3d const max =
+            start_line_.first.cwiseMax(start_line_.second).cwiseMax(end_line_.second).transpose();
+
+        while (next_scanned_ < tetrahedron_count_)
+        {
+            int const end = std::min(tetrahedron_count_, next_scanned_ + scan_block_size);
+            for (int t = next_scanned_; t < end; ++t)
+            {
+                Eigen::RowVector4i const tetrahedron = traits::tetrahedron(mesh_, t);
+                Eigen::RowVector3d tmin              = traits::vertex(mesh_, tetrahedron(0));
+                Eigen::RowVector3d tmax              = tmin;
+                for (int j = 1; j < 4; ++j)
+                {
+                    Eigen::RowVector3d const position = traits::vertex(mesh_, tetrahedron(j));
+                    tmin                              = tmin.cwiseMin(position);
+                    tmax                              = tmax.cwiseMax(position);
+                }
+
+                bool const overlaps =
+                    (tmin.array() <= max.array()).all() && (tmax.array() >= min.array()).all();
+                if (overlaps)
+                    candidates_.push_back(t);
+            }
+            next_scanned_ = end;
+
+            if (clock_type::now() >= deadline)
+                return;
+        }
+
+        order_candidates();
+        phase_ = candidates_.empty() ? phase_t::done : phase_t::cutting;
+        if (done())
+            cutter_.end_cut();
+    }
+
+    // sorts the candidates by the distance of their barycenters to end_line
+    void order_candidates()
+    {
+        Eigen::Vector3d const p = end_line_.first;
+        Eigen::Vector3d const d = end_line_.second - end_line_.first;
+        double const length2    = d.squaredNorm();
+
+        std::vector<double> distances(candidates_.size());
+        for (std::size_t i = 0; i < candidates_.size(); ++i)
+        {
+            Eigen::RowVector4i const tetrahedron = traits::tetrahedron(mesh_, candidates_[i]);
+            Eigen::Vector3d barycenter           = Eigen::Vector3d::Zero();
+            for (int j = 0; j < 4; ++j)
+                barycenter += 0.25 * traits::vertex(mesh_, tetrahedron(j)).transpose();
+
+            double const s =
+                length2 > 0. ? std::clamp((barycenter - p).dot(d) / length2, 0., 1.) : 0.;
+            distances[i] = (barycenter - (p + s * d)).squaredNorm();
+        }
+
+        std::vector<int> order(candidates_.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return distances[a] < distances[b];
+        });
+
+        std::vector<int> candidates(candidates_.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+            candidates[i] = candidates_[order[i]];
+        candidates_ = std::move(candidates);
+    }
+
+    void cut(clock_type::time_point deadline, int max_tetrahedra)
+    {
+        int const first_candidate      = next_candidate_;
+        int const first_vertex         = traits::vertex_count(mesh_);
+        int const first_tetrahedron    = traits::tetrahedron_count(mesh_);
+        int step_cut_count             = 0;
+        int staged_count               = 0;
+        int appended_vertex_count      = 0;
+        int appended_tetrahedron_count = 0;
+
+        auto now = clock_type::now();
+        while (next_candidate_ < static_cast<int>(candidates_.size()) &&
+               next_candidate_ - first_candidate < max_tetrahedra)
+        {
+            // stop if the next subdivision and the write are predicted to overrun the budget
+            if (next_candidate_ > first_candidate &&
+                now + subdivision_cost_ + write_cost_ > deadline)
+                break;
+
+            if (staged_.size() <= static_cast<std::size_t>(staged_count))
+                staged_.emplace_back();
+            auto& staged = staged_[staged_count];
+
+            int const t = candidates_[next_candidate_];
+            std::array<Eigen::RowVector3d, 4u> positions{};
+            Eigen::RowVector4i const tetrahedron = traits::tetrahedron(mesh_, t);
+            for (int i = 0; i < 4; ++i)
+                positions[i] = traits::vertex(mesh_, tetrahedron(i));
+
+            bool const result = detail::stage_subdivision(
+                cutter_,
+                tetrahedron,
+                positions,
+                staged,
+                [&](tetrahedron_mesh_cutter_t& cutter, Eigen::MatrixXd& V, Eigen::MatrixXi& T) {
+                    return cut_tetrahedron(cutter, V, T, 0, start_line_, end_line_);
+                });
+
+            bool const is_changed = staged.appended_vertex_count() > 0 ||
+                                    staged.appended_tetrahedron_count() > 0;
+            if (result)
+                ++step_cut_count;
+            if (result && is_changed)
+            {
+                // later subdivisions of the step share the vertices before they are written
+                detail::find_shared_vertices(cutter_, staged);
+                detail::share_staged_vertices(
+                    cutter_,
+                    staged,
+                    first_vertex + appended_vertex_count);
+
+                staged_rows_.resize(static_cast<std::size_t>(staged_count) + 1u);
+                staged_rows_[staged_count] = t;
+                appended_vertex_count += staged.appended_vertex_count();
+                appended_tetrahedron_count += staged.appended_tetrahedron_count();
+                ++staged_count;
+            }
+            ++next_candidate_;
+
+            auto const then   = now;
+            now               = clock_type::now();
+            subdivision_cost_ = average(subdivision_cost_, now - then);
+        }
+
+        is_blocked_ = !traits::append(mesh_, appended_vertex_count, appended_tetrahedron_count);
+        if (is_blocked_)
+        {
+            cutter_.unshare_vertices(first_vertex);
+            next_candidate_ = first_candidate;
+            return;
+        }
+
+        int next_vertex      = first_vertex;
+        int next_tetrahedron = first_tetrahedron;
+        for (int i = 0; i < staged_count; ++i)
+        {
+            auto& staged = staged_[i];
+            detail::commit_subdivision(
+                mesh_,
+                staged_rows_[i],
+                staged,
+                next_vertex,
+                next_tetrahedron,
+                !cutter_.defer_positions);
+            detail::record_subdivision(
+                cutter_,
+                staged_rows_[i],
+                staged,
+                next_vertex,
+                next_tetrahedron);
+
+            next_vertex += staged.appended_vertex_count();
+            next_tetrahedron += staged.appended_tetrahedron_count();
+        }
+
+        cut_count_ += step_cut_count;
+        write_cost_ = average(write_cost_, clock_type::now() - now);
+
+        if (next_candidate_ == static_cast<int>(candidates_.size()))
+        {
+            phase_ = phase_t::done;
+            cutter_.end_cut();
+        }
+    }
+
+    // exponential moving average of costs
+    static std::chrono::nanoseconds
+    average(std::chrono::nanoseconds mean, clock_type::duration cost)
+    {
+        auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(cost);
+        return mean.count() == 0 ? ns : (7 * mean + ns) / 8;
+    }
+
+    tetrahedron_mesh_cutter_t& cutter_;
+    Mesh& mesh_;
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> start_line_;
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> end_line_;
+    int tetrahedron_count_;
+
+    phase_t phase_{phase_t::scanning};
+    bool is_blocked_{false};
+    int next_scanned_{0};
+    int next_candidate_{0};
+    int cut_count_{0};
+    std::vector<int> candidates_{};
+
+    std::vector<detail::staged_subdivision_t> staged_{};
+    std::vector<int> staged_rows_{};
+
+    std::chrono::nanoseconds subdivision_cost_{0};
+    std::chrono::nanoseconds write_cost_{0};
+    latency_histogram_t latencies_{};
+};
+
+} // namespace geometry
+
+#endif // TET_CUT_BUDGETED_CUT_HPP
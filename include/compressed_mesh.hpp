@@ -0,0 +1,405 @@
+#ifndef TET_CUT_COMPRESSED_MESH_HPP
+#define TET_CUT_COMPRESSED_MESH_HPP
+
+#include "cut_tetrahedron.hpp"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <igl/parallel_for.h>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Compressed storage of the tetrahedra of a mesh. Consecutive tetrahedra are grouped in clusters
+ * of cluster_size, and each cluster stores its vertex indices as 16-bit offsets from a base
+ * vertex index, which halves the memory of an Eigen::MatrixXi when clusters are spatially coherent
+ * (see reorder_mesh). Clusters whose vertex indices span more than 16 bits are stored with full
+ * 32-bit indices instead. Rows are decoded on the fly, either one at a time or a cluster at once.
+ *
+ * Writes that do not fit a cluster's offsets rebase the cluster, or widen it if its vertex indices
+ * no longer fit 16 bits, leaving its offsets unused until the tetrahedra are compressed again.
+ */
+class compressed_tetrahedra_t
+{
+  public:
+    static int constexpr cluster_size = 256;
+
+    compressed_tetrahedra_t() = default;
+
+    explicit compressed_tetrahedra_t(Eigen::MatrixXi const& T) { compress(T); }
+
+    void compress(Eigen::MatrixXi const& T)
+    {
+        row_count_              = static_cast<int>(T.rows());
+        int const cluster_count = (row_count_ + cluster_size - 1) / cluster_size;
+        clusters_.assign(static_cast<std::size_t>(cluster_count), cluster_t{});
+
+        igl::parallel_for(
+            cluster_count,
+            [&](int c) {
+                int const begin = c * cluster_size;
+                int const end   = std::min(row_count_, begin + cluster_size);
+                int const min   = T.middleRows(begin, end - begin).minCoeff();
+                int const max   = T.middleRows(begin, end - begin).maxCoeff();
+
+                clusters_[c].base_vertex = min;
+                clusters_[c].is_wide     = max - min > std::numeric_limits<std::uint16_t>::max();
+            },
+            100u);
+
+        std::size_t offset_count = 0u;
+        std::size_t index_count  = 0u;
+        for (auto& cluster : clusters_)
+        {
+            std::size_t& count  = cluster.is_wide ? index_count : offset_count;
+            cluster.first_entry = count;
+            count += 4u * cluster_size;
+        }
+
+        offsets_.assign(offset_count, 0u);
+        indices_.assign(index_count, 0);
+
+        igl::parallel_for(
+            cluster_count,
+            [&](int c) {
+                int const begin = c * cluster_size;
+                int const end   = std::min(row_count_, begin + cluster_size);
+                for (int t = begin; t < end; ++t)
+                    for (int j = 0; j < 4; ++j)
+                        set_entry(clusters_[c], t - begin, j, T(t, j));
+            },
+            100u);
+    }
+
+    Eigen::MatrixXi decompress() const
+    {
+        Eigen::MatrixXi T(row_count_, 4);
+        igl::parallel_for(
+            cluster_count(),
+            [&](int c) {
+                int const begin = c * cluster_size;
+                int const end   = std::min(row_count_, begin + cluster_size);
+                for (int t = begin; t < end; ++t)
+                    for (int j = 0; j < 4; ++j)
+                        T(t, j) = entry(clusters_[c], t - begin, j);
+            },
+            100u);
+        return T;
+    }
+
+    int rows() const { return row_count_; }
+    int cluster_count() const { return static_cast<int>(clusters_.size()); }
+
+    /**
+     * @brief
+     * Number of tetrahedra in cluster c, which holds rows [c * cluster_size, c * cluster_size +
+     * cluster_rows(c))
+     */
+    int cluster_rows(int c) const { return std::min(cluster_size, row_count_ - c * cluster_size); }
+
+    Eigen::RowVector4i row(int t) const
+    {
+        auto const& cluster = clusters_[t / cluster_size];
+        int const i         = t % cluster_size;
+        return {
+            entry(cluster, i, 0),
+            entry(cluster, i, 1),
+            entry(cluster, i, 2),
+            entry(cluster, i, 3)};
+    }
+
+    /**
+     * @brief
+     * Decodes the tetrahedra of cluster c into the rows of block
+     */
+    void decode_cluster(int c, Eigen::MatrixXi& block) const
+    {
+        block.resize(cluster_rows(c), 4);
+        for (int i = 0; i < block.rows(); ++i)
+            for (int j = 0; j < 4; ++j)
+                block(i, j) = entry(clusters_[c], i, j);
+    }
+
+    void set_row(int t, Eigen::RowVector4i const& tetrahedron)
+    {
+        auto& cluster = clusters_[t / cluster_size];
+        int const i   = t % cluster_size;
+
+        bool const fits = cluster.is_wide ||
+                          (tetrahedron.minCoeff() >= cluster.base_vertex &&
+                           tetrahedron.maxCoeff() - cluster.base_vertex <=
+                               std::numeric_limits<std::uint16_t>::max());
+        if (!fits)
+            rebase(cluster, cluster_rows(t / cluster_size), tetrahedron);
+
+        for (int j = 0; j < 4; ++j)
+            set_entry(cluster, i, j, tetrahedron(j));
+    }
+
+    void push_back(Eigen::RowVector4i const& tetrahedron)
+    {
+        if (row_count_ % cluster_size == 0)
+        {
+            cluster_t cluster{};
+            cluster.base_vertex = tetrahedron.minCoeff();
+            cluster.first_entry = offsets_.size();
+            offsets_.resize(offsets_.size() + 4u * cluster_size, 0u);
+            clusters_.push_back(cluster);
+        }
+
+        ++row_count_;
+        set_row(row_count_ - 1, tetrahedron);
+    }
+
+    /**
+     * @brief
+     * Number of bytes used by the compressed tetrahedra
+     */
+    std::size_t memory_size() const
+    {
+        return clusters_.size() * sizeof(cluster_t) + offsets_.size() * sizeof(std::uint16_t) +
+               indices_.size() * sizeof(int);
+    }
+
+  private:
+    struct cluster_t
+    {
+        int base_vertex{0};
+        bool is_wide{false};
+        std::size_t first_entry{0u};
+    };
+
+    int entry(cluster_t const& cluster, int i, int j) const
+    {
+        std::size_t const k = cluster.first_entry + static_cast<std::size_t>(4 * i + j);
+        return cluster.is_wide ? indices_[k] : cluster.base_vertex + static_cast<int>(offsets_[k]);
+    }
+
+    void set_entry(cluster_t const& cluster, int i, int j, int v)
+    {
+        std::size_t const k = cluster.first_entry + static_cast<std::size_t>(4 * i + j);
+        if (cluster.is_wide)
+            indices_[k] = v;
+        else
+            offsets_[k] = static_cast<std::uint16_t>(v - cluster.base_vertex);
+    }
+
+    /**
+     * @brief
+     * Lowers the base vertex of a cluster such that its offsets also cover the given tetrahedron,
+     * or widens the cluster if its vertex indices would then span more than 16 bits
+     */
+    void rebase(cluster_t& cluster, int count, Eigen::RowVector4i const& tetrahedron)
+    {
+        int min = tetrahedron.minCoeff();
+        int max = tetrahedron.maxCoeff();
+        for (int i = 0; i < count; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                min = std::min(min, entry(cluster, i, j));
+                max = std::max(max, entry(cluster, i, j));
+            }
+        }
+
+        if (max - min > std::numeric_limits<std::uint16_t>::max())
+        {
+            widen(cluster, count);
+            return;
+        }
+
+        int const shift = cluster.base_vertex - min;
+        for (int i = 0; i < count; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                std::size_t const k = cluster.first_entry + static_cast<std::size_t>(4 * i + j);
+                offsets_[k]         = static_cast<std::uint16_t>(offsets_[k] + shift);
+            }
+        }
+        cluster.base_vertex = min;
+    }
+
+    void widen(cluster_t& cluster, int count)
+    {
+        std::size_t const first_entry = indices_.size();
+        indices_.resize(indices_.size() + 4u * cluster_size, 0);
+        for (int i = 0; i < count; ++i)
+            for (int j = 0; j < 4; ++j)
+                indices_[first_entry + static_cast<std::size_t>(4 * i + j)] = entry(cluster, i, j);
+
+        cluster.is_wide     = true;
+        cluster.first_entry = first_entry;
+    }
+
+    int row_count_{0};
+    std::vector<cluster_t> clusters_{};
+    std::vector<std::uint16_t> offsets_{};
+    std::vector<int> indices_{};
+};
+
+/**
+ * @brief
+ * Vertex positions quantized to 16 bits per coordinate within their bounding box, such that
+ * position i is origin + Q.row(i) * step
+ */
+struct quantized_vertices_t
+{
+    Eigen::RowVector3d origin{0., 0., 0.};
+    Eigen::RowVector3d step{1., 1., 1.};
+    Eigen::Matrix<std::uint16_t, Eigen::Dynamic, 3> Q{};
+
+    Eigen::RowVector3d row(int i) const
+    {
+        return origin + (Q.row(i).cast<double>().array() * step.array()).matrix();
+    }
+};
+
+quantized_vertices_t quantize_vertices(Eigen::MatrixXd const& V)
+{
+    quantized_vertices_t QV{};
+    QV.Q.resize(V.rows(), 3);
+    if (V.rows() == 0)
+        return QV;
+
+    double const levels = std::numeric_limits<std::uint16_t>::max();
+    QV.origin           = V.colwise().minCoeff();
+    QV.step             = ((V.colwise().maxCoeff() - QV.origin) / levels).cwiseMax(1e-300);
+
+    igl::parallel_for(
+        V.rows(),
+        [&](Eigen::Index i) {
+            for (int d = 0; d < 3; ++d)
+            {
+                double const q = std::round((V(i, d) - QV.origin(d)) / QV.step(d));
+                QV.Q(i, d)     = static_cast<std::uint16_t>(std::clamp(q, 0., levels));
+            }
+        },
+        1000u);
+
+    return QV;
+}
+
+Eigen::MatrixXd dequantize_vertices(quantized_vertices_t const& QV)
+{
+    Eigen::MatrixXd V(QV.Q.rows(), 3);
+    igl::parallel_for(
+        QV.Q.rows(),
+        [&](Eigen::Index i) { V.row(i) = QV.row(static_cast<int>(i)); },
+        1000u);
+    return V;
+}
+
+/**
+ * @brief
+ * Cuts every tetrahedron of the compressed mesh (V,CT) that is intersected by the triangle formed
+ * by start_line and end_line. Clusters are decoded on the fly for culling, and every candidate is
+ * cut as a single row matrix whose children are written back to CT. Emitted cut surface triangles
+ * and the subdivisions recorded in the cutter's delta refer to rows of CT. Journaling is not
+ * supported on compressed tetrahedra.
+ * @return Number of tetrahedra that were cut
+ */
+int cut_mesh(
+    tetrahedron_mesh_cutter_t& cutter,
+    Eigen::MatrixXd& V,
+    compressed_tetrahedra_t& CT,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line)
+{
+    assert(cutter.journal == nullptr);
+    cutter.quality = {};
+
+    Eigen::RowVector3d const min =
+        start_line.first.cwiseMin(start_line.second).cwiseMin(end_line.second).transpose();
+    Eigen::RowVector3d const max =
+        start_line.first.cwiseMax(start_line.second).cwiseMax(end_line.second).transpose();
+
+    auto& candidates = cutter.candidate_tetrahedra;
+    candidates.clear();
+
+    Eigen::MatrixXi block{};
+    for (int c = 0; c < CT.cluster_count(); ++c)
+    {
+        CT.decode_cluster(c, block);
+        for (int i = 0; i < block.rows(); ++i)
+        {
+            Eigen::RowVector3d tmin = V.row(block(i, 0));
+            Eigen::RowVector3d tmax = tmin;
+            for (int j = 1; j < 4; ++j)
+            {
+                tmin = tmin.cwiseMin(V.row(block(i, j)));
+                tmax = tmax.cwiseMax(V.row(block(i, j)));
+            }
+
+            bool const overlaps = (tmin.array() <= max.array()).all() &&
+                                  (tmax.array() >= min.array()).all();
+            if (overlaps)
+                candidates.push_back(c * compressed_tetrahedra_t::cluster_size + i);
+        }
+    }
+
+    // the local cut records rows of the single row matrix, so the delta records rows of CT here
+    auto* const delta = cutter.delta;
+    cutter.delta      = nullptr;
+
+    int cut_count = 0;
+    Eigen::MatrixXi T(1, 4);
+    cutter.begin_cut();
+    for (int const t : candidates)
+    {
+        T.resize(1, 4);
+        T.row(0) = CT.row(t);
+
+        int const vertex_count = static_cast<int>(V.rows());
+        std::size_t const first_triangle =
+            cutter.cut_surface != nullptr ? cutter.cut_surface->size() : 0u;
+        if (!cut_tetrahedron(cutter, V, T, 0, start_line, end_line))
+            continue;
+
+        ++cut_count;
+        int const first_child_row                     = CT.rows();
+        Eigen::RowVector4i const replaced_tetrahedron = CT.row(t);
+        CT.set_row(t, T.row(0));
+        for (int r = 1; r < T.rows(); ++r)
+            CT.push_back(T.row(r));
+
+        if (delta != nullptr && T.rows() > 1)
+        {
+            delta->record(
+                {t,
+                 replaced_tetrahedron,
+                 first_child_row,
+                 static_cast<int>(T.rows()) - 1,
+                 vertex_count,
+                 static_cast<int>(V.rows()) - vertex_count});
+        }
+
+        if (cutter.cut_surface == nullptr)
+            continue;
+
+        for (std::size_t i = first_triangle; i < cutter.cut_surface->size(); ++i)
+        {
+            auto& triangle  = (*cutter.cut_surface)[i];
+            int const child = triangle.tetrahedron;
+
+            triangle.tetrahedron            = child == 0 ? t : first_child_row + child - 1;
+            triangle.subdivided_tetrahedron = t;
+        }
+    }
+
+    cutter.end_cut();
+    cutter.delta = delta;
+    return cut_count;
+}
+
+} // namespace geometry
+
+#endif // TET_CUT_COMPRESSED_MESH_HPP
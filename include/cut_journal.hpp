@@ -0,0 +1,308 @@
+#ifndef TET_CUT_CUT_JOURNAL_HPP
+#define TET_CUT_CUT_JOURNAL_HPP
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Rows of (V,T) touched by a single tetrahedron subdivision. The subdivided tetrahedron's row is
+ * overwritten by one of its children and the remaining children and new vertices are appended.
+ */
+struct cut_record_t
+{
+    int tetrahedron;
+    Eigen::RowVector4i replaced_tetrahedron;
+    int first_appended_tetrahedron;
+    int appended_tetrahedron_count;
+    int first_appended_vertex;
+    int appended_vertex_count;
+};
+
+/**
+ * @brief
+ * Journal of the subdivisions applied to a tetrahedral mesh. Recorded cuts can be grouped in a
+ * transaction which is then either committed or rolled back by restoring the replaced rows and
+ * truncating the appended ones, without snapshotting (V,T).
+ *
+ * The journal also maintains the parent-child hierarchy of tetrahedra. Every tetrahedron that
+ * ever existed in the mesh is a node of the hierarchy, and every row of T maps to the node it
+ * currently holds.
+ */
+class cut_journal_t
+{
+  public:
+    struct node_t
+    {
+        Eigen::RowVector4i tetrahedron;
+        int parent;
+    };
+
+    cut_journal_t() = default;
+
+    /**
+     * @brief
+     * Creates a journal whose hierarchy roots are the tetrahedra of T
+     */
+    explicit cut_journal_t(Eigen::MatrixXi const& T) { reset(T); }
+
+    void reset(Eigen::MatrixXi const& T)
+    {
+        records_.clear();
+        nodes_.clear();
+        row_nodes_.clear();
+        is_transaction_active_ = false;
+
+        for (int t = 0; t < T.rows(); ++t)
+        {
+            nodes_.push_back({T.row(t), -1});
+            row_nodes_.push_back(t);
+        }
+    }
+
+    void record(Eigen::MatrixXi const& T, cut_record_t const& record)
+    {
+        if (is_transaction_active_)
+            records_.push_back(record);
+
+        row_nodes_.resize(T.rows(), -1);
+
+        int const parent               = row_nodes_[record.tetrahedron];
+        row_nodes_[record.tetrahedron] = static_cast<int>(nodes_.size());
+        nodes_.push_back({T.row(record.tetrahedron), parent});
+
+        int const end = record.first_appended_tetrahedron + record.appended_tetrahedron_count;
+        for (int t = record.first_appended_tetrahedron; t < end; ++t)
+        {
+            row_nodes_[t] = static_cast<int>(nodes_.size());
+            nodes_.push_back({T.row(t), parent});
+        }
+    }
+
+    void begin_transaction(Eigen::MatrixXd const& V, Eigen::MatrixXi const& T)
+    {
+        assert(!is_transaction_active_);
+        records_.clear();
+        is_transaction_active_         = true;
+        transaction_vertex_count_      = static_cast<int>(V.rows());
+        transaction_tetrahedron_count_ = static_cast<int>(T.rows());
+        transaction_node_count_        = static_cast<int>(nodes_.size());
+    }
+
+    void commit()
+    {
+        records_.clear();
+        is_transaction_active_ = false;
+    }
+
+    /**
+     * @brief
+     * Undoes the cuts recorded since begin_transaction in reverse order. Only the replaced rows
+     * are written, and appended rows are dropped by a single truncation of V and T.
+     */
+    void rollback(Eigen::MatrixXd& V, Eigen::MatrixXi& T)
+    {
+        assert(is_transaction_active_);
+        for (auto it = records_.rbegin(); it != records_.rend(); ++it)
+        {
+            T.row(it->tetrahedron)      = it->replaced_tetrahedron;
+            row_nodes_[it->tetrahedron] = nodes_[row_nodes_[it->tetrahedron]].parent;
+        }
+
+        V.conservativeResize(transaction_vertex_count_, Eigen::NoChange);
+        T.conservativeResize(transaction_tetrahedron_count_, Eigen::NoChange);
+        row_nodes_.resize(transaction_tetrahedron_count_);
+        nodes_.resize(transaction_node_count_);
+
+        records_.clear();
+        is_transaction_active_ = false;
+    }
+
+    bool is_transaction_active() const { return is_transaction_active_; }
+    std::vector<cut_record_t> const& records() const { return records_; }
+
+    /**
+     * @brief
+     * Hierarchy node currently held by row t of T
+     */
+    int node(int t) const { return row_nodes_[t]; }
+    node_t const& get_node(int node) const { return nodes_[node]; }
+
+    /**
+     * @brief
+     * Parent node of the tetrahedron in row t of T, or -1 if it has not been subdivided from
+     * another tetrahedron
+     */
+    int parent(int t) const { return nodes_[row_nodes_[t]].parent; }
+
+    /**
+     * @brief
+     * Node of the original mesh tetrahedron that the tetrahedron in row t of T descends from
+     */
+    int root(int t) const
+    {
+        int node = row_nodes_[t];
+        while (nodes_[node].parent != -1)
+            node = nodes_[node].parent;
+        return node;
+    }
+
+  private:
+    std::vector<cut_record_t> records_{};
+    std::vector<node_t> nodes_{};
+    std::vector<int> row_nodes_{};
+
+    bool is_transaction_active_{false};
+    int transaction_vertex_count_{0};
+    int transaction_tetrahedron_count_{0};
+    int transaction_node_count_{0};
+};
+
+/**
+ * @brief
+ * Changes made to a tetrahedral mesh by the cuts recorded since the last clear, for consumers that
+ * update per-tetrahedron or per-vertex data locally instead of rebuilding it, e.g. the local
+ * reassembly of a stiffness matrix.
+ *
+ * Removed tetrahedra are the rows whose tetrahedron, replaced_tetrahedra[i], was overwritten by a
+ * child. Those rows and the appended ranges hold the added tetrahedra. Rows added by a recorded
+ * cut and subdivided again by a later one are not reported as removed, since consumers never
+ * saw them.
+ */
+class cut_delta_t
+{
+  public:
+    void record(cut_record_t const& record)
+    {
+        records_.push_back(record);
+
+        // cuts visit rows in increasing order, such that the insertion is usually at the end
+        auto const it = std::lower_bound(
+            removed_tetrahedra_.begin(),
+            removed_tetrahedra_.end(),
+            record.tetrahedron);
+        bool const is_removed = it != removed_tetrahedra_.end() && *it == record.tetrahedron;
+        if (!is_removed && !is_added(record.tetrahedron))
+        {
+            replaced_tetrahedra_.insert(
+                replaced_tetrahedra_.begin() + (it - removed_tetrahedra_.begin()),
+                record.replaced_tetrahedron);
+            removed_tetrahedra_.insert(it, record.tetrahedron);
+        }
+
+        append_range(
+            added_tetrahedra_,
+            record.first_appended_tetrahedron,
+            record.appended_tetrahedron_count);
+        append_range(new_vertices_, record.first_appended_vertex, record.appended_vertex_count);
+    }
+
+    /**
+     * @brief
+     * Records vertices appended by a cut outside of its subdivisions' records, e.g. vertices that
+     * several subdivisions share
+     */
+    void record_vertices(int first_vertex, int vertex_count)
+    {
+        append_range(new_vertices_, first_vertex, vertex_count);
+    }
+
+    void clear()
+    {
+        records_.clear();
+        removed_tetrahedra_.clear();
+        replaced_tetrahedra_.clear();
+        added_tetrahedra_.clear();
+        new_vertices_.clear();
+    }
+
+    bool empty() const { return removed_tetrahedra_.empty() && added_tetrahedra_.empty(); }
+
+    /**
+     * @brief
+     * Recorded subdivisions in the order they were applied, for consumers that follow every
+     * subdivided row to its children
+     */
+    std::vector<cut_record_t> const& records() const { return records_; }
+
+    /**
+     * @brief
+     * Rows of removed tetrahedra in increasing order, which now hold added tetrahedra
+     */
+    std::vector<int> const& removed_tetrahedra() const { return removed_tetrahedra_; }
+    std::vector<Eigen::RowVector4i> const& replaced_tetrahedra() const
+    {
+        return replaced_tetrahedra_;
+    }
+
+    /**
+     * @brief
+     * Ranges [first, end) of appended rows holding added tetrahedra, resp. of new vertices
+     */
+    std::vector<std::pair<int, int>> const& added_tetrahedra() const { return added_tetrahedra_; }
+    std::vector<std::pair<int, int>> const& new_vertices() const { return new_vertices_; }
+
+    /**
+     * @brief
+     * Vertices of the removed and added tetrahedra in increasing order, i.e. the vertices whose
+     * one-ring changed
+     */
+    std::vector<int> affected_vertices(Eigen::MatrixXi const& T) const
+    {
+        std::vector<int> vertices{};
+        auto const insert = [&](Eigen::RowVector4i const& tetrahedron) {
+            vertices.insert(vertices.end(), tetrahedron.data(), tetrahedron.data() + 4);
+        };
+
+        for (std::size_t i = 0; i < removed_tetrahedra_.size(); ++i)
+        {
+            insert(replaced_tetrahedra_[i]);
+            insert(T.row(removed_tetrahedra_[i]));
+        }
+        for (auto const& [first, end] : added_tetrahedra_)
+            for (int t = first; t < end; ++t)
+                insert(T.row(t));
+
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+        return vertices;
+    }
+
+  private:
+    bool is_added(int t) const
+    {
+        auto const it = std::upper_bound(
+            added_tetrahedra_.begin(),
+            added_tetrahedra_.end(),
+            std::pair<int, int>{t, std::numeric_limits<int>::max()});
+        return it != added_tetrahedra_.begin() && t < std::prev(it)->second;
+    }
+
+    static void append_range(std::vector<std::pair<int, int>>& ranges, int first, int count)
+    {
+        if (count == 0)
+            return;
+
+        if (!ranges.empty() && ranges.back().second == first)
+            ranges.back().second += count;
+        else
+            ranges.push_back({first, first + count});
+    }
+
+    std::vector<cut_record_t> records_{};
+    std::vector<int> removed_tetrahedra_{};
+    std::vector<Eigen::RowVector4i> replaced_tetrahedra_{};
+    std::vector<std::pair<int, int>> added_tetrahedra_{};
+    std::vector<std::pair<int, int>> new_vertices_{};
+};
+
+} // namespace geometry
+
+#endif // TET_CUT_CUT_JOURNAL_HPP
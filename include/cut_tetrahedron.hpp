@@ -1,28 +1,331 @@
 #ifndef TET_CUT_CUT_TETRAHEDRON_HPP
 #define TET_CUT_CUT_TETRAHEDRON_HPP
 
+#include "attribute_transfer.hpp"
+#include "cut_journal.hpp"
 #include "intersection_tests.hpp"
+#include "mesh_primitives.hpp"
+#include "mesh_quality.hpp"
 
 #include <Eigen/Core>
+#include <algorithm>
 #include <array>
 #include <bitset>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace geometry {
 
+/**
+ * @brief
+ * Parameters of the snapping stage that runs before subdivision. Edge intersections lying within
+ * relative_tolerance (as a fraction of the edge's length) of one of the edge's endpoints are moved
+ * onto that endpoint, so that the cut passes through the existing vertex and a lower-order
+ * subdivision is selected instead of one producing slivers. Snapping is decided per tetrahedron,
+ * so neighbours that disagree about snapping a vertex they share are not kept conforming.
+ */
+struct snapping_parameters_t
+{
+    bool enabled{false};
+    double relative_tolerance{0.05};
+};
+
+/**
+ * @brief
+ * Intersection point of a tetrahedron and the cutting surface, along with the local tetrahedron
+ * vertices it interpolates (-1 if unused) and their interpolation weights. Edge intersections
+ * interpolate the edge's two vertices and face intersections the face's three vertices.
+ */
+struct intersection_point_t
+{
+    Eigen::Vector3d position{};
+    std::array<int, 3u> vertices{-1, -1, -1};
+    std::array<double, 3u> weights{0., 0., 0.};
+};
+
+/**
+ * @brief
+ * Triangle of the surface created by a cut, in counterclockwise order seen from outside of the
+ * child tetrahedron it bounds, along with the row of that child and the row of the subdivided
+ * tetrahedron (which now holds one of its children)
+ */
+struct cut_surface_triangle_t
+{
+    Eigen::RowVector3i vertices;
+    int tetrahedron;
+    int subdivided_tetrahedron;
+};
+
+namespace detail {
+
+// tetrahedron edges e1,...,e6 as pairs of local vertex indices
+std::array<std::array<int, 2u>, 6u> constexpr tetrahedron_edges{
+    {{0, 1}, {1, 2}, {2, 0}, {0, 3}, {1, 3}, {2, 3}}};
+
+int edge_index(int vi, int vj)
+{
+    for (int e = 0; e < 6; ++e)
+    {
+        auto const& edge = tetrahedron_edges[e];
+        if ((edge[0] == vi && edge[1] == vj) || (edge[0] == vj && edge[1] == vi))
+            return e;
+    }
+    return -1;
+}
+
+/**
+ * @brief
+ * Orders local vertices a,b,c,d as an even permutation of the tetrahedron's vertices by swapping
+ * c and d if necessary, such that the ordering preserves the tetrahedron's orientation
+ */
+std::array<int, 4u> positively_oriented(int a, int b, int c, int d)
+{
+    std::array<int, 4u> ordering{a, b, c, d};
+    int inversions = 0;
+    for (int i = 0; i < 4; ++i)
+        for (int j = i + 1; j < 4; ++j)
+            if (ordering[i] > ordering[j])
+                ++inversions;
+
+    if (inversions % 2 == 1)
+        std::swap(ordering[2], ordering[3]);
+
+    return ordering;
+}
+
+/**
+ * @brief
+ * Vertices of the mesh that the intersection described by source interpolates, in ascending
+ * order and followed by -1 for edge intersections, which identifies the crossed edge or face
+ */
+std::array<int, 3u> intersection_key(vertex_source_t const& source)
+{
+    std::array<int, 3u> key = source.vertices;
+    if (key[2] >= 0)
+        sort_face(key);
+    else if (key[0] > key[1])
+        std::swap(key[0], key[1]);
+    return key;
+}
+
+/**
+ * @brief
+ * Splits the pyramid with the given apex and quadrilateral base into 2 tetrahedra, where
+ * (apex,base[0],base[1],base[2]) is positively oriented. The base is split along its diagonal
+ * through its first vertex in the given order, such that neighbours sharing it split it the same
+ * way.
+ */
+template <class Less>
+std::array<Eigen::RowVector4i, 2u>
+split_pyramid(int apex, std::array<int, 4u> const& base, Less const& less)
+{
+    int const first = std::min({base[0], base[1], base[2], base[3]}, less);
+    if (first == base[0] || first == base[2])
+    {
+        return {
+            Eigen::RowVector4i{apex, base[0], base[1], base[2]},
+            Eigen::RowVector4i{apex, base[0], base[2], base[3]}};
+    }
+    return {
+        Eigen::RowVector4i{apex, base[0], base[1], base[3]},
+        Eigen::RowVector4i{apex, base[1], base[2], base[3]}};
+}
+
+/**
+ * @brief
+ * Splits the prism with bottom triangle (p[0],p[1],p[2]), top triangle (p[3],p[4],p[5]) and
+ * lateral edges (p[i],p[i+3]) into 3 tetrahedra, where (p[0],p[1],p[2],p[3]) is positively
+ * oriented. Every quadrilateral face is split along its diagonal through its first vertex in the
+ * given order, such that neighbours sharing it split it the same way, which always yields a valid
+ * subdivision of the prism.
+ */
+template <class Less>
+std::array<Eigen::RowVector4i, 3u> split_prism(std::array<int, 6u> p, Less const& less)
+{
+    // flipping the prism upside down and rotating it preserve its orientation
+    if (less(
+            *std::min_element(p.begin() + 3, p.end(), less),
+            *std::min_element(p.begin(), p.begin() + 3, less)))
+        p = {p[3], p[5], p[4], p[0], p[2], p[1]};
+
+    int const r = static_cast<int>(std::min_element(p.begin(), p.begin() + 3, less) - p.begin());
+    int const a = p[r];
+    int const b = p[(r + 1) % 3];
+    int const c = p[(r + 2) % 3];
+    int const d = p[3 + r];
+    int const e = p[3 + (r + 1) % 3];
+    int const f = p[3 + (r + 2) % 3];
+
+    // the faces containing a are split through a, which leaves the choice for face (b,c,f,e)
+    int const first = std::min({b, c, e, f}, less);
+    if (first == b || first == f)
+    {
+        return {
+            Eigen::RowVector4i{a, b, c, f},
+            Eigen::RowVector4i{a, b, f, e},
+            Eigen::RowVector4i{a, e, f, d}};
+    }
+    return {
+        Eigen::RowVector4i{a, b, c, e},
+        Eigen::RowVector4i{a, e, c, f},
+        Eigen::RowVector4i{a, e, f, d}};
+}
+
+} // namespace detail
+
 class tetrahedron_mesh_cutter_t
 {
   public:
+    snapping_parameters_t snapping{};
+
+    // when enabled, quality accumulates the quality of the tetrahedra produced by the current cut,
+    // i.e. by the subdivisions since cut_mesh started or quality was last reset
+    bool measure_quality{false};
+    tetrahedron_quality_t quality{};
+
+    // when set, every subdivision is recorded in the journal
+    cut_journal_t* journal{nullptr};
+
+    // when set, the rows touched by every subdivision are accumulated in the delta
+    cut_delta_t* delta{nullptr};
+
+    // when set, the source of every vertex created by a subdivision is appended to it
+    std::vector<vertex_source_t>* vertex_sources{nullptr};
+
+    // scratch buffer of cut_mesh, kept across cuts to avoid reallocations
+    std::vector<int> candidate_tetrahedra{};
+
+    // when enabled, the material is separated along the cutting surface
+    bool fracture{false};
+
+    // when set, the children faces lying on the cutting surface are appended to it
+    std::vector<cut_surface_triangle_t>* cut_surface{nullptr};
+
+    // when enabled, rows of new vertices are appended with zero positions, which are described by
+    // vertex_sources until materialize_vertices fills them in, and which must be filled in before
+    // the next cut. Requires vertex_sources, and excludes fracture and quality measurement, which
+    // need the positions, otherwise nothing is cut.
+    bool defer_positions{false};
+
+    // when set, TV holds deformed positions and the rows of new vertices are also appended to the
+    // rest positions, interpolated from the parents' rest positions with the same weights
+    Eigen::MatrixXd* rest_positions{nullptr};
+
+    // when set, TV and TT hold a local copy of one tetrahedron of a mesh, whose local vertices
+    // 0,...,3 stand for these vertices of the mesh. Subdivisions then split the faces they share
+    // with neighbours the way the neighbours do, and leave sharing vertices to the commit.
+    Eigen::RowVector4i const* local_vertices{nullptr};
+
+    // false if defer_positions is enabled without vertex_sources, or with fracture or quality
+    // measurement
+    bool can_defer_positions() const
+    {
+        return !defer_positions || (vertex_sources != nullptr && !fracture && !measure_quality);
+    }
+
+    /**
+     * @brief
+     * Starts a cut of a whole mesh, during which the subdivisions of neighbouring tetrahedra share
+     * the vertex they create on a common crossed edge or face, and its fracture copy, such that
+     * the cut mesh stays conforming. Vertices are identified by the vertices of the mesh they
+     * interpolate, so every subdivision until end_cut must be applied to the same mesh.
+     */
+    void begin_cut()
+    {
+        edge_vertices_.clear();
+        face_vertices_.clear();
+        vertex_copies_.clear();
+        is_sharing_vertices_ = true;
+    }
+
+    /**
+     * @brief
+     * Ends the cut started by begin_cut, after which every subdivision creates its own vertices
+     */
+    void end_cut()
+    {
+        edge_vertices_.clear();
+        face_vertices_.clear();
+        vertex_copies_.clear();
+        is_sharing_vertices_ = false;
+    }
+
+    bool is_sharing_vertices() const { return is_sharing_vertices_; }
+
+    /**
+     * @brief
+     * Vertex created since begin_cut at the intersection that source describes with vertices of
+     * the mesh, i.e. on the crossed edge or face they span
+     * @return Row of the vertex, -1 if there is none
+     */
+    int shared_vertex(vertex_source_t const& source) const
+    {
+        if (source.vertices[2] < 0)
+        {
+            auto const it =
+                edge_vertices_.find(detail::edge_key(source.vertices[0], source.vertices[1]));
+            return it != edge_vertices_.end() ? it->second : -1;
+        }
+
+        auto const it = face_vertices_.find(detail::intersection_key(source));
+        return it != face_vertices_.end() ? it->second : -1;
+    }
+
+    // shares the vertex source.vertex with the later subdivisions of the cut
+    void share_vertex(vertex_source_t const& source)
+    {
+        if (source.vertices[2] < 0)
+        {
+            edge_vertices_.emplace(
+                detail::edge_key(source.vertices[0], source.vertices[1]),
+                source.vertex);
+        }
+        else
+            face_vertices_.emplace(detail::intersection_key(source), source.vertex);
+    }
+
+    /**
+     * @brief
+     * Fracture copy made since begin_cut of vertex v
+     * @return Row of the copy, -1 if there is none
+     */
+    int shared_copy(int v) const
+    {
+        auto const it = vertex_copies_.find(v);
+        return it != vertex_copies_.end() ? it->second : -1;
+    }
+
+    // shares the fracture copy of vertex v with the later subdivisions of the cut
+    void share_copy(int v, int copy) { vertex_copies_.emplace(v, copy); }
+
+    // stops sharing the vertices from row first_vertex on, e.g. those of undone subdivisions
+    void unshare_vertices(int first_vertex)
+    {
+        auto const erase_from = [first_vertex](auto& vertices) {
+            for (auto it = vertices.begin(); it != vertices.end();)
+                it = it->second >= first_vertex ? vertices.erase(it) : std::next(it);
+        };
+        erase_from(edge_vertices_);
+        erase_from(face_vertices_);
+        erase_from(vertex_copies_);
+    }
+
     bool subdivide_mesh(
         std::byte const& edge_intersection_mask,
         Eigen::MatrixXd& TV,
         Eigen::MatrixXi& TT,
         int tetrahedron,
-        std::array<Eigen::Vector3d, 6u> const& edge_intersection_points,
-        std::array<Eigen::Vector3d, 4u> const& face_intersection_points)
+        std::array<intersection_point_t, 6u> const& edge_intersection_points,
+        std::array<intersection_point_t, 4u> const& face_intersection_points)
     {
+        subdivision_vertices_.clear();
+        subdivision_keys_.clear();
+
         int constexpr v1{0};
         int constexpr v2{1};
         int constexpr v3{2};
@@ -647,27 +950,428 @@ class tetrahedron_mesh_cutter_t
         return false;
     }
 
+    /**
+     * @brief
+     * Subdivides a tetrahedron whose cutting surface passes through the tetrahedron vertices in
+     * snapped_vertex_mask (bit i set for local vertex i). edge_intersection_mask holds the
+     * remaining edge intersections, which are not incident to any snapped vertex.
+     * @return True if the snapped configuration is supported, false otherwise
+     */
+    bool subdivide_snapped_mesh(
+        std::byte const& snapped_vertex_mask,
+        std::byte const& edge_intersection_mask,
+        Eigen::MatrixXd& TV,
+        Eigen::MatrixXi& TT,
+        int tetrahedron,
+        std::array<intersection_point_t, 6u> const& edge_intersection_points)
+    {
+        subdivision_vertices_.clear();
+        subdivision_keys_.clear();
+
+        // the cut runs along the tetrahedron's boundary, there is nothing to subdivide
+        if (edge_intersection_mask == std::byte{0b00000000})
+            return true;
+
+        std::bitset<4u> const snapped_vertices{std::to_integer<unsigned long>(snapped_vertex_mask)};
+        std::bitset<6u> const intersected_edges{
+            std::to_integer<unsigned long>(edge_intersection_mask)};
+
+        std::array<int, 2u> edges{};
+        int edge_count = 0;
+        for (int e = 0; e < 6 && edge_count < 2; ++e)
+            if (intersected_edges.test(e))
+                edges[edge_count++] = e;
+
+        if (snapped_vertices.count() == 1u && intersected_edges.count() == 2u)
+        {
+            auto const& ei = detail::tetrahedron_edges[edges[0]];
+            auto const& ej = detail::tetrahedron_edges[edges[1]];
+
+            // both intersected edges emanate from the vertex isolated by the cut
+            int const isolated = (ei[0] == ej[0] || ei[0] == ej[1]) ? ei[0] : ei[1];
+            int const vi       = ei[0] == isolated ? ei[1] : ei[0];
+            int const vj       = ej[0] == isolated ? ej[1] : ej[0];
+            int snapped        = 0;
+            while (!snapped_vertices.test(snapped))
+                ++snapped;
+
+            if (isolated == snapped || vi == vj || vi == snapped || vj == snapped)
+                return false;
+
+            auto const ordering = detail::positively_oriented(snapped, isolated, vi, vj);
+            int const e1        = detail::edge_index(isolated, ordering[2]);
+            int const e2        = detail::edge_index(isolated, ordering[3]);
+            auto const& pe1     = edge_intersection_points[e1];
+            auto const& pe2     = edge_intersection_points[e2];
+            subdivide_mesh_for_snapped_case_1(TV, TT, tetrahedron, ordering, {pe1, pe2});
+            return true;
+        }
+        if (snapped_vertices.count() == 2u && intersected_edges.count() == 1u)
+        {
+            // the intersected edge is opposite to the edge joining the snapped vertices
+            auto const& e = detail::tetrahedron_edges[edges[0]];
+            std::array<int, 2u> snapped{};
+            int snapped_count = 0;
+            for (int v = 0; v < 4; ++v)
+                if (snapped_vertices.test(v))
+                    snapped[snapped_count++] = v;
+
+            auto const ordering = detail::positively_oriented(snapped[0], snapped[1], e[0], e[1]);
+            auto const& pe1     = edge_intersection_points[edges[0]];
+            subdivide_mesh_for_snapped_case_2(TV, TT, tetrahedron, ordering, {pe1});
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief
+     * Separates the children of the last subdivision along the cutting surface. Every new vertex
+     * inside the cutting surface is duplicated, and children on the negative side of the cutting
+     * surface are relinked to the copies. Vertices on the boundary of the cutting surface, and
+     * existing vertices onto which intersections were snapped, stay shared by both sides. Between
+     * begin_cut and end_cut, a vertex shared with an earlier subdivision reuses its copy.
+     * @param TV Vertex positions
+     * @param TT Tetrahedra
+     * @param tetrahedron Subdivided tetrahedron
+     * @param first_appended_tetrahedron First row of TT holding a child appended by the
+     * subdivision
+     * @param is_negative Callable taking a row of TT and returning true if the child it holds is
+     * on the negative side of the cutting surface
+     */
+    template <class IsNegative>
+    void separate_cut_surface(
+        Eigen::MatrixXd& TV,
+        Eigen::MatrixXi& TT,
+        int tetrahedron,
+        int first_appended_tetrahedron,
+        IsNegative const& is_negative)
+    {
+        int const vertex_count = static_cast<int>(cut_surface_vertices_.size());
+        std::vector<int> copies(cut_surface_vertices_.size(), -1);
+        int copy_count = 0;
+        bool const is_sharing = is_sharing_vertices_ && local_vertices == nullptr;
+        for (int i = 0; i < vertex_count; ++i)
+        {
+            if (is_sharing)
+                copies[i] = shared_copy(cut_surface_vertices_[i].vertex);
+            if (copies[i] < 0)
+                ++copy_count;
+        }
+
+        int next_copy = static_cast<int>(TV.rows());
+        TV.conservativeResize(TV.rows() + copy_count, Eigen::NoChange);
+
+        if (rest_positions != nullptr)
+            rest_positions->conservativeResize(TV.rows(), Eigen::NoChange);
+
+        for (int i = 0; i < vertex_count; ++i)
+        {
+            if (copies[i] < 0)
+            {
+                vertex_source_t copy = cut_surface_vertices_[i];
+                TV.row(next_copy)    = TV.row(copy.vertex);
+                if (rest_positions != nullptr)
+                    rest_positions->row(next_copy) = rest_positions->row(copy.vertex);
+
+                if (is_sharing)
+                    share_copy(copy.vertex, next_copy);
+
+                copy.copied_vertex = copy.vertex;
+                copy.vertex        = next_copy;
+                if (vertex_sources != nullptr)
+                    vertex_sources->push_back(copy);
+
+                copies[i] = next_copy++;
+            }
+            subdivision_vertices_.push_back(copies[i]);
+        }
+
+        auto const separate_child = [&](int t) {
+            if (!is_negative(t))
+                return;
+
+            for (int j = 0; j < 4; ++j)
+                for (int i = 0; i < vertex_count; ++i)
+                    if (TT(t, j) == cut_surface_vertices_[i].vertex)
+                        TT(t, j) = copies[i];
+        };
+
+        separate_child(tetrahedron);
+        for (int t = first_appended_tetrahedron; t < TT.rows(); ++t)
+            separate_child(t);
+
+        cut_surface_vertices_.clear();
+    }
+
+    /**
+     * @brief
+     * Appends the faces of the children of the last subdivision that lie on the cutting surface
+     * to cut_surface. A face lies on the cutting surface when all of its vertices do, i.e. when
+     * they are intersection vertices of the subdivision (or their fracture copies) or existing
+     * vertices that intersections were snapped onto. Every such face is emitted once per adjacent
+     * child, oriented outwards of it.
+     * @param TT Tetrahedra
+     * @param tetrahedron Subdivided tetrahedron
+     * @param first_appended_tetrahedron First row of TT holding a child appended by the
+     * subdivision
+     * @param snapped_vertices Existing vertices lying on the cutting surface
+     */
+    void emit_cut_surface(
+        Eigen::MatrixXi const& TT,
+        int tetrahedron,
+        int first_appended_tetrahedron,
+        std::vector<int> const& snapped_vertices)
+    {
+        // faces of a positively oriented tetrahedron in counterclockwise order seen from outside
+        std::array<std::array<int, 3u>, 4u> constexpr TF{
+            {{0, 1, 3}, {1, 2, 3}, {2, 0, 3}, {0, 2, 1}}};
+
+        auto const is_on_cut_surface = [&](int v) {
+            return std::find(subdivision_vertices_.begin(), subdivision_vertices_.end(), v) !=
+                       subdivision_vertices_.end() ||
+                   std::find(snapped_vertices.begin(), snapped_vertices.end(), v) !=
+                       snapped_vertices.end();
+        };
+
+        auto const emit_child = [&](int t) {
+            for (auto const& face : TF)
+            {
+                Eigen::RowVector3i const triangle{TT(t, face[0]), TT(t, face[1]), TT(t, face[2])};
+                if (is_on_cut_surface(triangle(0)) && is_on_cut_surface(triangle(1)) &&
+                    is_on_cut_surface(triangle(2)))
+                {
+                    cut_surface->push_back({triangle, t, tetrahedron});
+                }
+            }
+        };
+
+        emit_child(tetrahedron);
+        for (int t = first_appended_tetrahedron; t < TT.rows(); ++t)
+            emit_child(t);
+    }
+
   private:
-    void subdivide_mesh_for_common_case_1(
+    /**
+     * @brief
+     * Source of vertex v at an intersection point of the tetrahedron, whose local vertices are
+     * replaced by the tetrahedron's global vertices
+     */
+    static vertex_source_t intersection_source(
+        Eigen::MatrixXi const& TT,
+        int tetrahedron,
+        int v,
+        intersection_point_t const& intersection_point)
+    {
+        vertex_source_t source{v, {-1, -1, -1}, intersection_point.weights};
+        for (int i = 0; i < 3; ++i)
+        {
+            int const local = intersection_point.vertices[i];
+            if (local >= 0)
+                source.vertices[i] = TT(tetrahedron, local);
+        }
+        return source;
+    }
+
+    /**
+     * @brief
+     * Returns the vertices of TV at the intersection points of the tetrahedron, which must not
+     * have been overwritten by its children yet. Between begin_cut and end_cut, a point on an
+     * edge or face crossed by an earlier subdivision reuses that subdivision's vertex, and the
+     * other points are appended as new vertices, otherwise all points are appended.
+     */
+    template <std::size_t N>
+    std::array<int, N> add_intersection_vertices(
+        Eigen::MatrixXd& TV,
+        Eigen::MatrixXi const& TT,
+        int tetrahedron,
+        std::array<intersection_point_t, N> const& intersection_points)
+    {
+        bool const is_sharing = is_sharing_vertices_ && local_vertices == nullptr;
+
+        std::array<int, N> vertices{};
+        int new_vertex_count = 0;
+        for (std::size_t i = 0u; i < N; ++i)
+        {
+            vertices[i] = -1;
+            if (is_sharing)
+            {
+                vertices[i] =
+                    shared_vertex(intersection_source(TT, tetrahedron, -1, intersection_points[i]));
+            }
+            if (vertices[i] < 0)
+                ++new_vertex_count;
+        }
+
+        int next_vertex = static_cast<int>(TV.rows());
+        TV.conservativeResize(TV.rows() + new_vertex_count, Eigen::NoChange);
+
+        for (std::size_t i = 0u; i < N; ++i)
+        {
+            bool const is_new_vertex = vertices[i] < 0;
+            if (is_new_vertex)
+                vertices[i] = next_vertex++;
+
+            vertex_source_t const source =
+                intersection_source(TT, tetrahedron, vertices[i], intersection_points[i]);
+            if (is_new_vertex)
+                set_intersection_vertex(TV, TT, tetrahedron, vertices[i], intersection_points[i]);
+            if (is_new_vertex && is_sharing)
+                share_vertex(source);
+
+            // a shared vertex is separated again along the children of this subdivision
+            bool const is_edge_intersection = source.vertices[2] < 0;
+            if (!is_new_vertex && fracture && is_edge_intersection)
+                cut_surface_vertices_.push_back(source);
+
+            subdivision_vertices_.push_back(vertices[i]);
+            subdivision_keys_.push_back(detail::intersection_key(global_source(source)));
+        }
+
+        return vertices;
+    }
+
+    // source with the vertices of the mesh that the local vertices stand for, if any
+    vertex_source_t global_source(vertex_source_t source) const
+    {
+        if (local_vertices != nullptr)
+            for (int& parent : source.vertices)
+                if (parent >= 0)
+                    parent = (*local_vertices)(parent);
+        return source;
+    }
+
+    /**
+     * @brief
+     * Orders the vertices of the last subdivision by the vertices of the mesh they stand for, or
+     * interpolate, such that neighbouring subdivisions order the vertices they share the same way
+     */
+    auto vertex_order() const
+    {
+        auto const key = [this](int v) {
+            for (std::size_t i = 0u; i < subdivision_keys_.size(); ++i)
+                if (subdivision_vertices_[i] == v)
+                    return subdivision_keys_[i];
+
+            int const vertex = local_vertices != nullptr ? (*local_vertices)(v) : v;
+            return std::array<int, 3u>{vertex, -1, -1};
+        };
+        return [key](int vi, int vj) { return key(vi) < key(vj); };
+    }
+
+    /**
+     * @brief
+     * Writes the position of new vertex v of TV from an intersection point of the tetrahedron,
+     * which must not have been overwritten by its children yet
+     */
+    void set_intersection_vertex(
+        Eigen::MatrixXd& TV,
+        Eigen::MatrixXi const& TT,
+        int tetrahedron,
+        int v,
+        intersection_point_t const& intersection_point)
+    {
+        if (defer_positions)
+            TV.row(v).setZero();
+        else
+            TV.row(v) = intersection_point.position.transpose();
+
+        if (vertex_sources == nullptr && !fracture && rest_positions == nullptr)
+            return;
+
+        vertex_source_t const source = intersection_source(TT, tetrahedron, v, intersection_point);
+
+        if (rest_positions != nullptr)
+        {
+            if (rest_positions->rows() < TV.rows())
+                rest_positions->conservativeResize(TV.rows(), Eigen::NoChange);
+
+            auto& rest = *rest_positions;
+            rest.row(v).setZero();
+            for (int i = 0; i < 3; ++i)
+                if (source.vertices[i] >= 0)
+                    rest.row(v) += source.weights[i] * rest.row(source.vertices[i]);
+        }
+
+        if (vertex_sources != nullptr)
+            vertex_sources->push_back(source);
+
+        // edge intersections lie inside the cutting surface, whereas face intersections lie on
+        // its boundary and keep both sides of the cut connected
+        bool const is_edge_intersection = intersection_point.vertices[2] < 0;
+        if (fracture && is_edge_intersection)
+            cut_surface_vertices_.push_back(source);
+    }
+
+    void subdivide_mesh_for_snapped_case_1(
+        Eigen::MatrixXd& TV,
+        Eigen::MatrixXi& TT,
+        int tetrahedron,
+        std::array<int, 4u> const& vertex_ordering,
+        std::array<intersection_point_t, 2u> const& edge_intersection_points)
+    {
+        // v1 lies on the cutting surface, which separates v2 from v3 and v4
+        int const v1 = TT.row(tetrahedron)(vertex_ordering[0]);
+        int const v2 = TT.row(tetrahedron)(vertex_ordering[1]);
+        int const v3 = TT.row(tetrahedron)(vertex_ordering[2]);
+        int const v4 = TT.row(tetrahedron)(vertex_ordering[3]);
+
+        auto const [v5, v6] =
+            add_intersection_vertices(TV, TT, tetrahedron, edge_intersection_points);
+
+        int constexpr new_tetrahedron_count = 3u;
+        int const t1                        = tetrahedron;
+        int const t2                        = TT.rows();
+        int const t3                        = TT.rows() + 1;
+
+        // v2 is cut off, leaving a pyramid with apex v1 whose base lies on face (v2,v3,v4)
+        auto const pyramid = detail::split_pyramid(v1, {v5, v3, v4, v6}, vertex_order());
+
+        TT.conservativeResize(TT.rows() + (new_tetrahedron_count - 1), Eigen::NoChange);
+        TT.row(t1) = Eigen::RowVector4i{v1, v2, v5, v6};
+        TT.row(t2) = pyramid[0];
+        TT.row(t3) = pyramid[1];
+    }
+
+    void subdivide_mesh_for_snapped_case_2(
         Eigen::MatrixXd& TV,
         Eigen::MatrixXi& TT,
         int tetrahedron,
         std::array<int, 4u> const& vertex_ordering,
-        std::array<Eigen::Vector3d, 3u> const& edge_intersection_points)
+        std::array<intersection_point_t, 1u> const& edge_intersection_points)
     {
+        // v1 and v2 lie on the cutting surface, which separates v3 from v4
         int const v1 = TT.row(tetrahedron)(vertex_ordering[0]);
         int const v2 = TT.row(tetrahedron)(vertex_ordering[1]);
         int const v3 = TT.row(tetrahedron)(vertex_ordering[2]);
         int const v4 = TT.row(tetrahedron)(vertex_ordering[3]);
 
-        int const v5 = TV.rows();
-        int const v6 = v5 + 1u;
-        int const v7 = v5 + 2u;
-        TV.conservativeResize(TV.rows() + 3u, Eigen::NoChange);
+        auto const [v5] = add_intersection_vertices(TV, TT, tetrahedron, edge_intersection_points);
 
-        TV.row(v5) = edge_intersection_points[0].transpose();
-        TV.row(v6) = edge_intersection_points[1].transpose();
-        TV.row(v7) = edge_intersection_points[2].transpose();
+        int constexpr new_tetrahedron_count = 2u;
+        int const t1                        = tetrahedron;
+        int const t2                        = TT.rows();
+
+        TT.conservativeResize(TT.rows() + (new_tetrahedron_count - 1), Eigen::NoChange);
+        TT.row(t1) = Eigen::RowVector4i{v1, v2, v3, v5};
+        TT.row(t2) = Eigen::RowVector4i{v1, v2, v5, v4};
+    }
+
+    void subdivide_mesh_for_common_case_1(
+        Eigen::MatrixXd& TV,
+        Eigen::MatrixXi& TT,
+        int tetrahedron,
+        std::array<int, 4u> const& vertex_ordering,
+        std::array<intersection_point_t, 3u> const& edge_intersection_points)
+    {
+        int const v1 = TT.row(tetrahedron)(vertex_ordering[0]);
+        int const v2 = TT.row(tetrahedron)(vertex_ordering[1]);
+        int const v3 = TT.row(tetrahedron)(vertex_ordering[2]);
+        int const v4 = TT.row(tetrahedron)(vertex_ordering[3]);
+
+        auto const [v5, v6, v7] =
+            add_intersection_vertices(TV, TT, tetrahedron, edge_intersection_points);
 
         int constexpr new_tetrahedron_count = 4u;
         int const t1                        = tetrahedron;
@@ -675,10 +1379,13 @@ class tetrahedron_mesh_cutter_t
         int const t3                        = TT.rows() + 1;
         int const t4                        = TT.rows() + 2;
 
+        // v4 is cut off, leaving a prism between face (v1,v2,v3) and the cut
+        auto const prism = detail::split_prism({v1, v2, v3, v5, v6, v7}, vertex_order());
+
         TT.conservativeResize(TT.rows() + (new_tetrahedron_count - 1), Eigen::NoChange);
-        TT.row(t1) = Eigen::RowVector4i{v1, v2, v3, v7};
-        TT.row(t2) = Eigen::RowVector4i{v1, v5, v2, v7};
-        TT.row(t3) = Eigen::RowVector4i{v6, v5, v7, v2};
+        TT.row(t1) = prism[0];
+        TT.row(t2) = prism[1];
+        TT.row(t3) = prism[2];
         TT.row(t4) = Eigen::RowVector4i{v5, v6, v7, v4};
     }
 
@@ -687,24 +1394,15 @@ class tetrahedron_mesh_cutter_t
         Eigen::MatrixXi& TT,
         int tetrahedron,
         std::array<int, 4u> const& vertex_ordering,
-        std::array<Eigen::Vector3d, 4u> const& edge_intersection_points)
+        std::array<intersection_point_t, 4u> const& edge_intersection_points)
     {
         int const v1 = TT.row(tetrahedron)(vertex_ordering[0]);
         int const v2 = TT.row(tetrahedron)(vertex_ordering[1]);
         int const v3 = TT.row(tetrahedron)(vertex_ordering[2]);
         int const v4 = TT.row(tetrahedron)(vertex_ordering[3]);
 
-        int constexpr new_vertex_count = 4u;
-        int const v5                   = TV.rows();
-        int const v6                   = v5 + 1u;
-        int const v7                   = v5 + 2u;
-        int const v8                   = v5 + 3u;
-        TV.conservativeResize(TV.rows() + new_vertex_count, Eigen::NoChange);
-
-        TV.row(v5) = edge_intersection_points[0].transpose();
-        TV.row(v6) = edge_intersection_points[1].transpose();
-        TV.row(v7) = edge_intersection_points[2].transpose();
-        TV.row(v8) = edge_intersection_points[3].transpose();
+        auto const [v5, v6, v7, v8] =
+            add_intersection_vertices(TV, TT, tetrahedron, edge_intersection_points);
 
         int constexpr new_tetrahedron_count = 6u;
         int const t1                        = tetrahedron;
@@ -714,13 +1412,17 @@ class tetrahedron_mesh_cutter_t
         int const t5                        = TT.rows() + 3;
         int const t6                        = TT.rows() + 4;
 
+        // the cut separates edge (v3,v4) from edge (v1,v2), leaving a prism on either side
+        auto const prism_34 = detail::split_prism({v3, v6, v7, v4, v5, v8}, vertex_order());
+        auto const prism_12 = detail::split_prism({v1, v6, v5, v2, v7, v8}, vertex_order());
+
         TT.conservativeResize(TT.rows() + (new_tetrahedron_count - 1), Eigen::NoChange);
-        TT.row(t1) = Eigen::RowVector4i{v5, v8, v6, v4};
-        TT.row(t2) = Eigen::RowVector4i{v6, v8, v7, v4};
-        TT.row(t3) = Eigen::RowVector4i{v6, v7, v3, v4};
-        TT.row(t4) = Eigen::RowVector4i{v5, v6, v8, v1};
-        TT.row(t5) = Eigen::RowVector4i{v1, v2, v6, v8};
-        TT.row(t6) = Eigen::RowVector4i{v2, v7, v6, v8};
+        TT.row(t1) = prism_34[0];
+        TT.row(t2) = prism_34[1];
+        TT.row(t3) = prism_34[2];
+        TT.row(t4) = prism_12[0];
+        TT.row(t5) = prism_12[1];
+        TT.row(t6) = prism_12[2];
     }
 
     void subdivide_mesh_for_common_case_3(
@@ -728,23 +1430,22 @@ class tetrahedron_mesh_cutter_t
         Eigen::MatrixXi& TT,
         int tetrahedron,
         std::array<int, 4u> const& vertex_ordering,
-        std::array<Eigen::Vector3d, 1u> const& edge_intersection_points,
-        std::array<Eigen::Vector3d, 2u> const& face_intersection_points)
+        std::array<intersection_point_t, 1u> const& edge_intersection_points,
+        std::array<intersection_point_t, 2u> const& face_intersection_points)
     {
         int const v1 = TT.row(tetrahedron)(vertex_ordering[0]);
         int const v2 = TT.row(tetrahedron)(vertex_ordering[1]);
         int const v3 = TT.row(tetrahedron)(vertex_ordering[2]);
         int const v4 = TT.row(tetrahedron)(vertex_ordering[3]);
 
-        int constexpr new_vertex_count = 3u;
-        int const v5                   = TV.rows();
-        int const v6                   = v5 + 1u;
-        int const v7                   = v5 + 2u;
-        TV.conservativeResize(TV.rows() + new_vertex_count, Eigen::NoChange);
-
-        TV.row(v5) = edge_intersection_points[0].transpose();
-        TV.row(v6) = face_intersection_points[0].transpose();
-        TV.row(v7) = face_intersection_points[1].transpose();
+        auto const [v5, v6, v7] = add_intersection_vertices(
+            TV,
+            TT,
+            tetrahedron,
+            std::array<intersection_point_t, 3u>{
+                edge_intersection_points[0],
+                face_intersection_points[0],
+                face_intersection_points[1]});
 
         int constexpr new_tetrahedron_count = 6u;
         int const t1                        = tetrahedron;
@@ -768,25 +1469,23 @@ class tetrahedron_mesh_cutter_t
         Eigen::MatrixXi& TT,
         int tetrahedron,
         std::array<int, 4u> const& vertex_ordering,
-        std::array<Eigen::Vector3d, 2u> const& edge_intersection_points,
-        std::array<Eigen::Vector3d, 2u> const& face_intersection_points)
+        std::array<intersection_point_t, 2u> const& edge_intersection_points,
+        std::array<intersection_point_t, 2u> const& face_intersection_points)
     {
         int const v1 = TT.row(tetrahedron)(vertex_ordering[0]);
         int const v2 = TT.row(tetrahedron)(vertex_ordering[1]);
         int const v3 = TT.row(tetrahedron)(vertex_ordering[2]);
         int const v4 = TT.row(tetrahedron)(vertex_ordering[3]);
 
-        int constexpr new_vertex_count = 4u;
-        int const v5                   = TV.rows();
-        int const v6                   = v5 + 1u;
-        int const v7                   = v5 + 2u;
-        int const v8                   = v5 + 3u;
-        TV.conservativeResize(TV.rows() + new_vertex_count, Eigen::NoChange);
-
-        TV.row(v5) = edge_intersection_points[0].transpose();
-        TV.row(v6) = edge_intersection_points[1].transpose();
-        TV.row(v7) = face_intersection_points[0].transpose();
-        TV.row(v8) = face_intersection_points[1].transpose();
+        auto const [v5, v6, v7, v8] = add_intersection_vertices(
+            TV,
+            TT,
+            tetrahedron,
+            std::array<intersection_point_t, 4u>{
+                edge_intersection_points[0],
+                edge_intersection_points[1],
+                face_intersection_points[0],
+                face_intersection_points[1]});
 
         int constexpr new_tetrahedron_count = 8u;
         int const t1                        = tetrahedron;
@@ -814,8 +1513,8 @@ class tetrahedron_mesh_cutter_t
         Eigen::MatrixXi& TT,
         int tetrahedron,
         std::array<int, 4u> const& vertex_ordering,
-        std::array<Eigen::Vector3d, 3u> const& edge_intersection_points,
-        std::array<Eigen::Vector3d, 2u> const& face_intersection_points,
+        std::array<intersection_point_t, 3u> const& edge_intersection_points,
+        std::array<intersection_point_t, 2u> const& face_intersection_points,
         bool symmetry = false)
     {
         int const v1 = TT.row(tetrahedron)(vertex_ordering[0]);
@@ -823,19 +1522,16 @@ class tetrahedron_mesh_cutter_t
         int const v3 = TT.row(tetrahedron)(vertex_ordering[2]);
         int const v4 = TT.row(tetrahedron)(vertex_ordering[3]);
 
-        int constexpr new_vertex_count = 5u;
-        int const v5                   = TV.rows();
-        int const v6                   = v5 + 1u;
-        int const v7                   = v5 + 2u;
-        int const v8                   = v5 + 3u;
-        int const v9                   = v5 + 4u;
-        TV.conservativeResize(TV.rows() + new_vertex_count, Eigen::NoChange);
-
-        TV.row(v5) = edge_intersection_points[0].transpose();
-        TV.row(v6) = edge_intersection_points[1].transpose();
-        TV.row(v7) = edge_intersection_points[2].transpose();
-        TV.row(v8) = face_intersection_points[0].transpose();
-        TV.row(v9) = face_intersection_points[1].transpose();
+        auto const [v5, v6, v7, v8, v9] = add_intersection_vertices(
+            TV,
+            TT,
+            tetrahedron,
+            std::array<intersection_point_t, 5u>{
+                edge_intersection_points[0],
+                edge_intersection_points[1],
+                edge_intersection_points[2],
+                face_intersection_points[0],
+                face_intersection_points[1]});
 
         int constexpr new_tetrahedron_count = 9u;
         int const t1                        = tetrahedron;
@@ -874,9 +1570,23 @@ class tetrahedron_mesh_cutter_t
             TT.row(t9) = Eigen::RowVector4i{v8, v7, v3, v6};
         }
     }
+
+    std::vector<vertex_source_t> cut_surface_vertices_{};
+
+    // intersection vertices of the last subdivision, followed by their fracture copies, and the
+    // keys of the vertices of the mesh that the intersection vertices interpolate
+    std::vector<int> subdivision_vertices_{};
+    std::vector<std::array<int, 3u>> subdivision_keys_{};
+
+    // vertices created on crossed edges and faces, and fracture copies of vertices, by the
+    // subdivisions since begin_cut, keyed by the global vertices they interpolate
+    bool is_sharing_vertices_{false};
+    std::unordered_map<std::uint64_t, int> edge_vertices_{};
+    std::unordered_map<std::array<int, 3u>, int, detail::indices_hash_t> face_vertices_{};
+    std::unordered_map<int, int> vertex_copies_{};
 };
 
-std::pair<std::byte, std::array<Eigen::Vector3d, 6u>> get_edge_intersections(
+std::pair<std::byte, std::array<intersection_point_t, 6u>> get_edge_intersections(
     Eigen::Vector3d const& v1,
     Eigen::Vector3d const& v2,
     Eigen::Vector3d const& v3,
@@ -885,57 +1595,34 @@ std::pair<std::byte, std::array<Eigen::Vector3d, 6u>> get_edge_intersections(
     Eigen::Vector3d const& b,
     Eigen::Vector3d const& c)
 {
-    auto const [e1_intersected, e1_intersection] =
-        geometry::triangle_line_intersection_two_way(a, b, c, {v1, v2});
-    auto const [e2_intersected, e2_intersection] =
-        geometry::triangle_line_intersection_two_way(a, b, c, {v2, v3});
-    auto const [e3_intersected, e3_intersection] =
-        geometry::triangle_line_intersection_two_way(a, b, c, {v3, v1});
-    auto const [e4_intersected, e4_intersection] =
-        geometry::triangle_line_intersection_two_way(a, b, c, {v1, v4});
-    auto const [e5_intersected, e5_intersection] =
-        geometry::triangle_line_intersection_two_way(a, b, c, {v2, v4});
-    auto const [e6_intersected, e6_intersection] =
-        geometry::triangle_line_intersection_two_way(a, b, c, {v3, v4});
+    std::array<Eigen::Vector3d, 4u> const vertices{v1, v2, v3, v4};
 
     std::byte mask{0b00000000};
-    std::array<Eigen::Vector3d, 6u> edge_intersections{};
+    std::array<intersection_point_t, 6u> edge_intersections{};
 
-    if (e1_intersected)
-    {
-        mask |= std::byte{0b00000001};
-        edge_intersections[0] = e1_intersection;
-    }
-    if (e2_intersected)
-    {
-        mask |= std::byte{0b00000010};
-        edge_intersections[1] = e2_intersection;
-    }
-    if (e3_intersected)
-    {
-        mask |= std::byte{0b00000100};
-        edge_intersections[2] = e3_intersection;
-    }
-    if (e4_intersected)
-    {
-        mask |= std::byte{0b00001000};
-        edge_intersections[3] = e4_intersection;
-    }
-    if (e5_intersected)
-    {
-        mask |= std::byte{0b00010000};
-        edge_intersections[4] = e5_intersection;
-    }
-    if (e6_intersected)
+    for (int e = 0; e < 6; ++e)
     {
-        mask |= std::byte{0b00100000};
-        edge_intersections[5] = e6_intersection;
+        auto const& edge        = detail::tetrahedron_edges[e];
+        auto const intersection = geometry::intersect_triangle_line_two_way(
+            a,
+            b,
+            c,
+            {vertices[edge[0]], vertices[edge[1]]});
+
+        if (intersection.intersects)
+        {
+            mask |= std::byte{static_cast<unsigned char>(1u << e)};
+            edge_intersections[e] = {
+                intersection.point,
+                {edge[0], edge[1], -1},
+                {1. - intersection.t, intersection.t, 0.}};
+        }
     }
 
     return {mask, edge_intersections};
 }
 
-std::pair<std::byte, std::array<Eigen::Vector3d, 4u>> get_face_intersections(
+std::pair<std::byte, std::array<intersection_point_t, 4u>> get_face_intersections(
     Eigen::Vector3d const& pos1,
     Eigen::Vector3d const& pos2,
     Eigen::Vector3d const& pos3,
@@ -953,168 +1640,42 @@ std::pair<std::byte, std::array<Eigen::Vector3d, 4u>> get_face_intersections(
     int constexpr v3 = 2;
     int constexpr v4 = 3;
 
-    Eigen::MatrixXi TF(4u, 3u);
-    TF.row(0u) = Eigen::RowVector3i{v1, v2, v4};
-    TF.row(1u) = Eigen::RowVector3i{v2, v3, v4};
-    TF.row(2u) = Eigen::RowVector3i{v3, v1, v4};
-    TF.row(3u) = Eigen::RowVector3i{v1, v3, v2};
-
-    int constexpr f1 = 0;
-    int constexpr f2 = 1;
-    int constexpr f3 = 2;
-    int constexpr f4 = 3;
+    std::array<std::array<int, 3u>, 4u> constexpr TF{
+        {{v1, v2, v4}, {v2, v3, v4}, {v3, v1, v4}, {v1, v3, v2}}};
 
     std::array<Eigen::Vector3d, 4u> vertices{pos1, pos2, pos3, pos4};
 
-    std::array<Eigen::Vector3d, 4u> face_intersections{};
+    std::array<intersection_point_t, 4u> face_intersections{};
 
-    std::byte start_line_mask{0b00000000};
-
-    // intersect tet faces with line p1-q1
-    {
-        auto const [f1_intersected, f1_intersection] = geometry::triangle_line_intersection_two_way(
-            vertices[TF(f1, 0)],
-            vertices[TF(f1, 1)],
-            vertices[TF(f1, 2)],
-            {p1, q1});
-
-        auto const [f2_intersected, f2_intersection] = geometry::triangle_line_intersection_two_way(
-            vertices[TF(f2, 0)],
-            vertices[TF(f2, 1)],
-            vertices[TF(f2, 2)],
-            {p1, q1});
-
-        auto const [f3_intersected, f3_intersection] = geometry::triangle_line_intersection_two_way(
-            vertices[TF(f3, 0)],
-            vertices[TF(f3, 1)],
-            vertices[TF(f3, 2)],
-            {p1, q1});
-
-        auto const [f4_intersected, f4_intersection] = geometry::triangle_line_intersection_two_way(
-            vertices[TF(f4, 0)],
-            vertices[TF(f4, 1)],
-            vertices[TF(f4, 2)],
-            {p1, q1});
-
-        if (f1_intersected)
+    // intersect tet faces with a line, later lines overwrite face intersections of earlier ones
+    auto const intersect_faces = [&](Eigen::Vector3d const& p, Eigen::Vector3d const& q) {
+        std::byte line_mask{0b00000000};
+        for (int f = 0; f < 4; ++f)
         {
-            start_line_mask |= std::byte{0b00000001};
-            face_intersections[0] = f1_intersection;
+            auto const& face        = TF[f];
+            auto const intersection = geometry::intersect_triangle_line_two_way(
+                vertices[face[0]],
+                vertices[face[1]],
+                vertices[face[2]],
+                {p, q});
+
+            if (intersection.intersects)
+            {
+                line_mask |= std::byte{static_cast<unsigned char>(1u << f)};
+                face_intersections[f] = {
+                    intersection.point,
+                    face,
+                    {intersection.barycentric(0),
+                     intersection.barycentric(1),
+                     intersection.barycentric(2)}};
+            }
         }
-        if (f2_intersected)
-        {
-            start_line_mask |= std::byte{0b00000010};
-            face_intersections[1] = f2_intersection;
-        }
-        if (f3_intersected)
-        {
-            start_line_mask |= std::byte{0b00000100};
-            face_intersections[2] = f3_intersection;
-        }
-        if (f4_intersected)
-        {
-            start_line_mask |= std::byte{0b00001000};
-            face_intersections[3] = f4_intersection;
-        }
-    }
-
-    std::byte end_line_mask{0b00000000};
-    // intersect tet faces with line p2-q2
-    {
-        auto const [f1_intersected, f1_intersection] = geometry::triangle_line_intersection_two_way(
-            vertices[TF(f1, 0)],
-            vertices[TF(f1, 1)],
-            vertices[TF(f1, 2)],
-            {p2, q2});
-
-        auto const [f2_intersected, f2_intersection] = geometry::triangle_line_intersection_two_way(
-            vertices[TF(f2, 0)],
-            vertices[TF(f2, 1)],
-            vertices[TF(f2, 2)],
-            {p2, q2});
-
-        auto const [f3_intersected, f3_intersection] = geometry::triangle_line_intersection_two_way(
-            vertices[TF(f3, 0)],
-            vertices[TF(f3, 1)],
-            vertices[TF(f3, 2)],
-            {p2, q2});
-
-        auto const [f4_intersected, f4_intersection] = geometry::triangle_line_intersection_two_way(
-            vertices[TF(f4, 0)],
-            vertices[TF(f4, 1)],
-            vertices[TF(f4, 2)],
-            {p2, q2});
-
-        if (f1_intersected)
-        {
-            end_line_mask |= std::byte{0b00000001};
-            face_intersections[0] = f1_intersection;
-        }
-        if (f2_intersected)
-        {
-            end_line_mask |= std::byte{0b00000010};
-            face_intersections[1] = f2_intersection;
-        }
-        if (f3_intersected)
-        {
-            end_line_mask |= std::byte{0b00000100};
-            face_intersections[2] = f3_intersection;
-        }
-        if (f4_intersected)
-        {
-            end_line_mask |= std::byte{0b00001000};
-            face_intersections[3] = f4_intersection;
-        }
-    }
+        return line_mask;
+    };
 
-    std::byte invisible_line_mask{0b00000000};
-    // intersect tet faces with line q1-q2
-    {
-        auto const [f1_intersected, f1_intersection] = geometry::triangle_line_intersection_two_way(
-            vertices[TF(f1, 0)],
-            vertices[TF(f1, 1)],
-            vertices[TF(f1, 2)],
-            {q1, q2});
-
-        auto const [f2_intersected, f2_intersection] = geometry::triangle_line_intersection_two_way(
-            vertices[TF(f2, 0)],
-            vertices[TF(f2, 1)],
-            vertices[TF(f2, 2)],
-            {q1, q2});
-
-        auto const [f3_intersected, f3_intersection] = geometry::triangle_line_intersection_two_way(
-            vertices[TF(f3, 0)],
-            vertices[TF(f3, 1)],
-            vertices[TF(f3, 2)],
-            {q1, q2});
-
-        auto const [f4_intersected, f4_intersection] = geometry::triangle_line_intersection_two_way(
-            vertices[TF(f4, 0)],
-            vertices[TF(f4, 1)],
-            vertices[TF(f4, 2)],
-            {q1, q2});
-
-        if (f1_intersected)
-        {
-            invisible_line_mask |= std::byte{0b00000001};
-            face_intersections[0] = f1_intersection;
-        }
-        if (f2_intersected)
-        {
-            invisible_line_mask |= std::byte{0b00000010};
-            face_intersections[1] = f2_intersection;
-        }
-        if (f3_intersected)
-        {
-            invisible_line_mask |= std::byte{0b00000100};
-            face_intersections[2] = f3_intersection;
-        }
-        if (f4_intersected)
-        {
-            invisible_line_mask |= std::byte{0b00001000};
-            face_intersections[3] = f4_intersection;
-        }
-    }
+    std::byte const start_line_mask     = intersect_faces(p1, q1);
+    std::byte const end_line_mask       = intersect_faces(p2, q2);
+    std::byte const invisible_line_mask = intersect_faces(q1, q2);
 
     if ((start_line_mask & end_line_mask) != std::byte{0b00000000} ||
         (start_line_mask & invisible_line_mask) != std::byte{0b00000000} ||
@@ -1127,7 +1688,180 @@ std::pair<std::byte, std::array<Eigen::Vector3d, 4u>> get_face_intersections(
     return {mask, face_intersections};
 }
 
+/**
+ * @brief
+ * Snaps edge intersections lying within a relative tolerance of one of their edge's endpoints
+ * onto that endpoint. The tolerance is measured along the edge, such that tetrahedra sharing an
+ * edge make the same decision. Only cuts that separate the tetrahedron are snapped, since the
+ * cutting surface's boundary lies inside the tetrahedron for the other cases.
+ * @param edge_intersection_mask Intersected edges of the tetrahedron
+ * @param edge_intersection_points Edge intersection points
+ * @param relative_tolerance Tolerance as a fraction of edge length
+ * @return Pair of the edge intersection mask without edges incident to snapped vertices and the
+ * mask of snapped vertices
+ */
+std::pair<std::byte, std::byte> snap_edge_intersections(
+    std::byte const& edge_intersection_mask,
+    std::array<intersection_point_t, 6u> const& edge_intersection_points,
+    double relative_tolerance)
+{
+    std::array<std::byte, 7u> constexpr separating_masks{
+        std::byte{0b00010011},
+        std::byte{0b00001101},
+        std::byte{0b00100110},
+        std::byte{0b00111000},
+        std::byte{0b00101011},
+        std::byte{0b00110101},
+        std::byte{0b00011110}};
+
+    bool is_separating = false;
+    for (auto const& mask : separating_masks)
+        is_separating = is_separating || mask == edge_intersection_mask;
+
+    if (!is_separating)
+        return {edge_intersection_mask, std::byte{0b00000000}};
+
+    std::byte snapped_vertex_mask{0b00000000};
+    for (int e = 0; e < 6; ++e)
+    {
+        std::byte const edge_bit{static_cast<unsigned char>(1u << e)};
+        if ((edge_intersection_mask & edge_bit) == std::byte{0b00000000})
+            continue;
+
+        auto const& edge = detail::tetrahedron_edges[e];
+        double const t   = edge_intersection_points[e].weights[1];
+
+        if (t < relative_tolerance)
+            snapped_vertex_mask |= std::byte{static_cast<unsigned char>(1u << edge[0])};
+        if (t > 1. - relative_tolerance)
+            snapped_vertex_mask |= std::byte{static_cast<unsigned char>(1u << edge[1])};
+    }
+
+    std::byte snapped_edge_mask = edge_intersection_mask;
+    for (int e = 0; e < 6; ++e)
+    {
+        auto const& edge = detail::tetrahedron_edges[e];
+        std::byte const vertex_bits{static_cast<unsigned char>((1u << edge[0]) | (1u << edge[1]))};
+        if ((snapped_vertex_mask & vertex_bits) != std::byte{0b00000000})
+            snapped_edge_mask &= ~std::byte{static_cast<unsigned char>(1u << e)};
+    }
+
+    return {snapped_edge_mask, snapped_vertex_mask};
+}
+
+/**
+ * @brief
+ * Subdivides a tetrahedron of the mesh (V,T) given its edge and face intersections with a cutting
+ * surface, using the given cutter's snapping, fracture, cut surface, quality measurement and
+ * journaling parameters
+ * @param is_negative Callable taking a row of T and returning true if the child it holds is on the
+ * negative side of the cutting surface, used for fracture
+ * @param surface_vertex_mask Vertices known to lie on the cutting surface, whose edges are not
+ * intersected and which are treated as snapped, whether snapping is enabled or not
+ * @return True if the intersection pattern is supported
+ */
+template <class IsNegative>
+bool subdivide_tetrahedron(
+    tetrahedron_mesh_cutter_t& cutter,
+    Eigen::MatrixXd& V,
+    Eigen::MatrixXi& T,
+    int tetrahedron,
+    std::byte const& edge_intersection_mask,
+    std::array<intersection_point_t, 6u> const& edge_intersections,
+    std::array<intersection_point_t, 4u> const& face_intersections,
+    IsNegative const& is_negative,
+    std::byte const& surface_vertex_mask = std::byte{0b00000000})
+{
+    if (!cutter.can_defer_positions())
+        return false;
+
+    double const volume = cutter.measure_quality ? signed_volume(V, T, tetrahedron) : 0.;
+    int const tetrahedron_count                   = static_cast<int>(T.rows());
+    int const vertex_count                        = static_cast<int>(V.rows());
+    Eigen::RowVector4i const replaced_tetrahedron = T.row(tetrahedron);
+
+    bool is_snapped = false;
+    std::byte snapped_vertex_mask{surface_vertex_mask};
+    std::byte snapped_edge_mask{edge_intersection_mask};
+    if (cutter.snapping.enabled && surface_vertex_mask == std::byte{0b00000000})
+    {
+        auto const snapped_pair = snap_edge_intersections(
+            edge_intersection_mask,
+            edge_intersections,
+            cutter.snapping.relative_tolerance);
+        snapped_edge_mask   = snapped_pair.first;
+        snapped_vertex_mask = snapped_pair.second;
+    }
+
+    if (snapped_vertex_mask != std::byte{0b00000000})
+    {
+        is_snapped = cutter.subdivide_snapped_mesh(
+            snapped_vertex_mask,
+            snapped_edge_mask,
+            V,
+            T,
+            tetrahedron,
+            edge_intersections);
+    }
+
+    bool const result = is_snapped || cutter.subdivide_mesh(
+                                          edge_intersection_mask,
+                                          V,
+                                          T,
+                                          tetrahedron,
+                                          edge_intersections,
+                                          face_intersections);
+
+    if (result && cutter.fracture)
+        cutter.separate_cut_surface(V, T, tetrahedron, tetrahedron_count, is_negative);
+
+    if (result && cutter.cut_surface != nullptr && T.rows() > tetrahedron_count)
+    {
+        std::vector<int> snapped_vertices{};
+        for (int v = 0; is_snapped && v < 4; ++v)
+            if ((snapped_vertex_mask & std::byte{static_cast<unsigned char>(1u << v)}) !=
+                std::byte{0b00000000})
+                snapped_vertices.push_back(replaced_tetrahedron(v));
+
+        cutter.emit_cut_surface(T, tetrahedron, tetrahedron_count, snapped_vertices);
+    }
+
+    if (result && cutter.measure_quality)
+    {
+        std::vector<int> tetrahedra{tetrahedron};
+        for (int t = tetrahedron_count; t < T.rows(); ++t)
+            tetrahedra.push_back(t);
+
+        cutter.quality.merge(compute_tetrahedron_quality(V, T, tetrahedra, volume));
+    }
+
+    if (result && T.rows() > tetrahedron_count)
+    {
+        cut_record_t const record{
+            tetrahedron,
+            replaced_tetrahedron,
+            tetrahedron_count,
+            static_cast<int>(T.rows()) - tetrahedron_count,
+            vertex_count,
+            static_cast<int>(V.rows()) - vertex_count};
+
+        if (cutter.journal != nullptr)
+            cutter.journal->record(T, record);
+        if (cutter.delta != nullptr)
+            cutter.delta->record(record);
+    }
+
+    return result;
+}
+
+/**
+ * @brief
+ * Cuts a tetrahedron of the mesh (V,T) with the triangle formed by start_line and end_line, using
+ * the given cutter's snapping, fracture, cut surface, quality measurement and journaling parameters
+ * @return True if the tetrahedron's intersection with the cutting triangle is supported
+ */
 bool cut_tetrahedron(
+    tetrahedron_mesh_cutter_t& cutter,
     Eigen::MatrixXd& V,
     Eigen::MatrixXi& T,
     int tetrahedron,
@@ -1158,23 +1892,125 @@ bool cut_tetrahedron(
     auto const& pos4 = V.row(T(tetrahedron, 3)).transpose();
 
     auto edge_pair = get_edge_intersections(pos1, pos2, pos3, pos4, a, b, c);
-    std::byte const edge_intersection_mask                   = edge_pair.first;
-    std::array<Eigen::Vector3d, 6u> const edge_intersections = edge_pair.second;
+    std::byte const edge_intersection_mask                        = edge_pair.first;
+    std::array<intersection_point_t, 6u> const edge_intersections = edge_pair.second;
 
     auto face_pair = get_face_intersections(pos1, pos2, pos3, pos4, start_line, end_line);
-    std::byte const face_intersection_mask                   = face_pair.first;
-    std::array<Eigen::Vector3d, 4u> const face_intersections = face_pair.second;
-
-    tetrahedron_mesh_cutter_t cutter{};
-    bool const result = cutter.subdivide_mesh(
-        edge_intersection_mask,
+    std::byte const face_intersection_mask                        = face_pair.first;
+    std::array<intersection_point_t, 4u> const face_intersections = face_pair.second;
+
+    Eigen::Vector3d const normal = (b - a).cross(c - a);
+    auto const is_negative       = [&](int t) {
+        Eigen::Vector3d const barycenter =
+            0.25 * (V.row(T(t, 0)) + V.row(T(t, 1)) + V.row(T(t, 2)) + V.row(T(t, 3))).transpose();
+        return normal.dot(barycenter - a) < 0.;
+    };
+
+    return subdivide_tetrahedron(
+        cutter,
         V,
         T,
         tetrahedron,
+        edge_intersection_mask,
         edge_intersections,
-        face_intersections);
+        face_intersections,
+        is_negative);
+}
 
-    return result;
+bool cut_tetrahedron(
+    Eigen::MatrixXd& V,
+    Eigen::MatrixXi& T,
+    int tetrahedron,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line)
+{
+    tetrahedron_mesh_cutter_t cutter{};
+    return cut_tetrahedron(cutter, V, T, tetrahedron, start_line, end_line);
+}
+
+/**
+ * @brief
+ * Cuts every tetrahedron of the mesh (V,T) that is intersected by the triangle formed by
+ * start_line and end_line. Tetrahedra whose bounding box does not overlap the triangle's are
+ * culled before the intersection tests. If the cutter defers positions, materialize_vertices must
+ * fill in the new vertices before the next cut, which would otherwise intersect the triangle with
+ * zero positions.
+ * @return Number of tetrahedra that were cut, 0 if the cutter cannot defer positions
+ */
+int cut_mesh(
+    tetrahedron_mesh_cutter_t& cutter,
+    Eigen::MatrixXd& V,
+    Eigen::MatrixXi& T,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line)
+{
+    cutter.quality = {};
+    if (!cutter.can_defer_positions())
+        return 0;
+
+    Eigen::Vector3d const min =
+        start_line.first.cwiseMin(start_line.second).cwiseMin(end_line.second);
+    Eigen::Vector3d const max =
+        start_line.first.cwiseMax(start_line.second).cwiseMax(end_line.second);
+
+    auto& candidates = cutter.candidate_tetrahedra;
+    candidates.clear();
+    for (int t = 0; t < T.rows(); ++t)
+    {
+        Eigen::RowVector3d tmin = V.row(T(t, 0));
+        Eigen::RowVector3d tmax = tmin;
+        for (int j = 1; j < 4; ++j)
+        {
+            tmin = tmin.cwiseMin(V.row(T(t, j)));
+            tmax = tmax.cwiseMax(V.row(T(t, j)));
+        }
+
+        bool const overlaps = (tmin.transpose().array() <= max.array()).all() &&
+                              (tmax.transpose().array() >= min.array()).all();
+        if (overlaps)
+            candidates.push_back(t);
+    }
+
+    int cut_count = 0;
+    cutter.begin_cut();
+    for (int const t : candidates)
+    {
+        if (cut_tetrahedron(cutter, V, T, t, start_line, end_line))
+            ++cut_count;
+    }
+    cutter.end_cut();
+
+    return cut_count;
+}
+
+/**
+ * @brief
+ * Cuts every tetrahedron of the mesh (X,T) that is intersected by the triangle formed by
+ * start_line and end_line, where X holds the deformed positions of the mesh whose rest positions
+ * are V. Tetrahedra are classified and subdivided in the deformed configuration, and every new
+ * vertex is appended to both X and V with the same interpolation weights, in a single pass.
+ * @param X Deformed vertex positions
+ * @param V Rest vertex positions
+ * @param T Tetrahedra
+ * @return Number of tetrahedra that were cut
+ */
+int cut_mesh(
+    tetrahedron_mesh_cutter_t& cutter,
+    Eigen::MatrixXd& X,
+    Eigen::MatrixXd& V,
+    Eigen::MatrixXi& T,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line)
+{
+    assert(X.rows() == V.rows());
+
+    auto* const rest_positions = cutter.rest_positions;
+    cutter.rest_positions      = &V;
+    int const cut_count        = cut_mesh(cutter, X, T, start_line, end_line);
+    cutter.rest_positions      = rest_positions;
+
+    assert(X.rows() == V.rows());
+    return cut_count;
 }
 
 } // namespace geometry
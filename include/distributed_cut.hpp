@@ -0,0 +1,756 @@
+#ifndef TET_CUT_DISTRIBUTED_CUT_HPP
+#define TET_CUT_DISTRIBUTED_CUT_HPP
+
+#include "cut_tetrahedron.hpp"
+#include "domain_decomposition.hpp"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <mpi.h>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+namespace detail {
+
+template <class T>
+MPI_Datatype mpi_datatype();
+
+template <>
+MPI_Datatype mpi_datatype<int>()
+{
+    return MPI_INT;
+}
+
+template <>
+MPI_Datatype mpi_datatype<double>()
+{
+    return MPI_DOUBLE;
+}
+
+/**
+ * @brief
+ * Sends sends[q] to every process q and receives what every process sent to this one
+ * @return Received values, by sending process
+ */
+template <class T>
+std::vector<std::vector<T>> exchange(MPI_Comm comm, std::vector<std::vector<T>> const& sends)
+{
+    int const size = static_cast<int>(sends.size());
+
+    std::vector<int> send_counts(sends.size()), send_offsets(sends.size() + 1u, 0);
+    for (int q = 0; q < size; ++q)
+    {
+        send_counts[q]      = static_cast<int>(sends[q].size());
+        send_offsets[q + 1] = send_offsets[q] + send_counts[q];
+    }
+
+    std::vector<int> receive_counts(sends.size()), receive_offsets(sends.size() + 1u, 0);
+    MPI_Alltoall(send_counts.data(), 1, MPI_INT, receive_counts.data(), 1, MPI_INT, comm);
+    for (int q = 0; q < size; ++q)
+        receive_offsets[q + 1] = receive_offsets[q] + receive_counts[q];
+
+    std::vector<T> send_buffer{}, receive_buffer(static_cast<std::size_t>(receive_offsets[size]));
+    send_buffer.reserve(static_cast<std::size_t>(send_offsets[size]));
+    for (auto const& values : sends)
+        send_buffer.insert(send_buffer.end(), values.begin(), values.end());
+
+    MPI_Alltoallv(
+        send_buffer.data(),
+        send_counts.data(),
+        send_offsets.data(),
+        mpi_datatype<T>(),
+        receive_buffer.data(),
+        receive_counts.data(),
+        receive_offsets.data(),
+        mpi_datatype<T>(),
+        comm);
+
+    std::vector<std::vector<T>> received(sends.size());
+    for (int q = 0; q < size; ++q)
+        received[q].assign(
+            receive_buffer.begin() + receive_offsets[q],
+            receive_buffer.begin() + receive_offsets[q + 1]);
+
+    return received;
+}
+
+/**
+ * @brief
+ * Gathers the values of all processes on every process
+ * @return Values of processes 0,...,size-1, concatenated
+ */
+template <class T>
+std::vector<T> all_gather(MPI_Comm comm, std::vector<T> const& values)
+{
+    int size = 0;
+    MPI_Comm_size(comm, &size);
+
+    int const count = static_cast<int>(values.size());
+    std::vector<int> counts(static_cast<std::size_t>(size)), offsets(counts.size() + 1u, 0);
+    MPI_Allgather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, comm);
+    for (int q = 0; q < size; ++q)
+        offsets[q + 1] = offsets[q] + counts[q];
+
+    std::vector<T> gathered(static_cast<std::size_t>(offsets[size]));
+    MPI_Allgatherv(
+        values.data(),
+        count,
+        mpi_datatype<T>(),
+        gathered.data(),
+        counts.data(),
+        offsets.data(),
+        mpi_datatype<T>(),
+        comm);
+
+    return gathered;
+}
+
+template <class T>
+void send_vector(MPI_Comm comm, std::vector<T> const& values, int destination)
+{
+    int const count = static_cast<int>(values.size());
+    MPI_Send(&count, 1, MPI_INT, destination, 0, comm);
+    MPI_Send(values.data(), count, mpi_datatype<T>(), destination, 0, comm);
+}
+
+template <class T>
+std::vector<T> receive_vector(MPI_Comm comm, int source)
+{
+    int count = 0;
+    MPI_Recv(&count, 1, MPI_INT, source, 0, comm, MPI_STATUS_IGNORE);
+    std::vector<T> values(static_cast<std::size_t>(count));
+    MPI_Recv(values.data(), count, mpi_datatype<T>(), source, 0, comm, MPI_STATUS_IGNORE);
+    return values;
+}
+
+/**
+ * @brief
+ * Serializes a partition into integer and floating point buffers
+ */
+std::pair<std::vector<int>, std::vector<double>> pack_partition(mesh_partition_t const& partition)
+{
+    std::vector<int> ints{
+        partition.part,
+        partition.global_vertex_count,
+        partition.global_tetrahedron_count,
+        static_cast<int>(partition.V.rows()),
+        static_cast<int>(partition.T.rows())};
+
+    ints.insert(ints.end(), partition.global_vertices.begin(), partition.global_vertices.end());
+    ints.insert(ints.end(), partition.global_tetrahedra.begin(), partition.global_tetrahedra.end());
+    ints.insert(ints.end(), partition.owners.begin(), partition.owners.end());
+    for (int t = 0; t < partition.T.rows(); ++t)
+        for (int j = 0; j < 4; ++j)
+            ints.push_back(partition.T(t, j));
+    for (auto const& rows : partition.halo_rows)
+    {
+        ints.push_back(static_cast<int>(rows.size()));
+        ints.insert(ints.end(), rows.begin(), rows.end());
+    }
+
+    std::vector<double> doubles{};
+    doubles.reserve(3u * static_cast<std::size_t>(partition.V.rows()));
+    for (int v = 0; v < partition.V.rows(); ++v)
+        for (int d = 0; d < 3; ++d)
+            doubles.push_back(partition.V(v, d));
+
+    return {std::move(ints), std::move(doubles)};
+}
+
+mesh_partition_t unpack_partition(
+    std::vector<int> const& ints,
+    std::vector<double> const& doubles,
+    int part_count)
+{
+    mesh_partition_t partition{};
+    auto it                            = ints.begin();
+    partition.part                     = *it++;
+    partition.global_vertex_count      = *it++;
+    partition.global_tetrahedron_count = *it++;
+    int const vertex_count             = *it++;
+    int const tetrahedron_count        = *it++;
+
+    partition.global_vertices.assign(it, it + vertex_count);
+    it += vertex_count;
+    partition.global_tetrahedra.assign(it, it + tetrahedron_count);
+    it += tetrahedron_count;
+    partition.owners.assign(it, it + tetrahedron_count);
+    it += tetrahedron_count;
+
+    partition.T.resize(tetrahedron_count, 4);
+    for (int t = 0; t < tetrahedron_count; ++t)
+        for (int j = 0; j < 4; ++j)
+            partition.T(t, j) = *it++;
+
+    partition.halo_rows.resize(static_cast<std::size_t>(part_count));
+    for (auto& rows : partition.halo_rows)
+    {
+        int const count = *it++;
+        rows.assign(it, it + count);
+        it += count;
+    }
+
+    partition.V.resize(vertex_count, 3);
+    for (int v = 0; v < vertex_count; ++v)
+        for (int d = 0; d < 3; ++d)
+            partition.V(v, d) = doubles[3u * static_cast<std::size_t>(v) + d];
+
+    return partition;
+}
+
+/**
+ * @brief
+ * Renumbers the local vertices of a partition in order of their global indices, which vertices
+ * appended by cuts and halo exchanges do not follow
+ */
+void sort_partition_vertices(mesh_partition_t& partition)
+{
+    auto& global_vertices = partition.global_vertices;
+    if (std::is_sorted(global_vertices.begin(), global_vertices.end()))
+        return;
+
+    std::vector<int> order(global_vertices.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return global_vertices[a] < global_vertices[b];
+    });
+
+    std::vector<int> rows(order.size());
+    Eigen::MatrixXd V(partition.V.rows(), 3);
+    std::vector<int> sorted_vertices(order.size());
+    for (int v = 0; v < static_cast<int>(order.size()); ++v)
+    {
+        rows[order[v]]     = v;
+        V.row(v)           = partition.V.row(order[v]);
+        sorted_vertices[v] = global_vertices[order[v]];
+    }
+
+    partition.V     = std::move(V);
+    global_vertices = std::move(sorted_vertices);
+    partition.T     = partition.T.unaryExpr([&](int v) { return rows[v]; }).eval();
+}
+
+} // namespace detail
+
+/**
+ * @brief
+ * Partitions the mesh (V,T) of the root process into one partition with halo per process of comm
+ * and sends every process its partition. The partitions are extracted and sent one at a time,
+ * such that the root holds at most one partition besides the mesh.
+ * @param comm Communicator of the processes
+ * @param V Vertex positions, only read on the root process
+ * @param T Tetrahedra, only read on the root process
+ * @param root Process holding the mesh
+ * @return Partition of this process
+ */
+mesh_partition_t scatter_mesh(
+    MPI_Comm comm,
+    Eigen::MatrixXd const& V,
+    Eigen::MatrixXi const& T,
+    int root = 0)
+{
+    int rank = 0, size = 0;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    if (rank != root)
+    {
+        auto const ints    = detail::receive_vector<int>(comm, root);
+        auto const doubles = detail::receive_vector<double>(comm, root);
+        return detail::unpack_partition(ints, doubles, size);
+    }
+
+    auto const parts        = partition_tetrahedra(V, T, size);
+    auto const vertex_parts = detail::find_vertex_parts(V, T, parts, size);
+    for (int q = 0; q < size; ++q)
+    {
+        if (q == root)
+            continue;
+
+        auto const [ints, doubles] =
+            detail::pack_partition(detail::extract_partition(V, T, parts, vertex_parts, q));
+        detail::send_vector(comm, ints, q);
+        detail::send_vector(comm, doubles, q);
+    }
+
+    return detail::extract_partition(V, T, parts, vertex_parts, root);
+}
+
+/**
+ * @brief
+ * Cuts the owned tetrahedra of every process' partition that are intersected by the triangle
+ * formed by start_line and end_line, numbers the new vertices and tetrahedra globally, and
+ * refreshes the halo layers. Must be called by all processes of comm.
+ *
+ * Every tetrahedron is cut by the process owning it, with the same arithmetic as a single
+ * process cut. New vertices are identified across partitions by the global vertices of the edge
+ * or face they cross, such that processes cutting tetrahedra around a crossed edge or face on a
+ * partition boundary agree on one vertex. Every vertex takes the global index and position that
+ * the first tetrahedron creating it in global order gives it, and new tetrahedra are numbered as
+ * if all tetrahedra had been cut in global order by one process, such that gathering the
+ * partitions gives the result of cut_mesh on the whole mesh. The owners of cut tetrahedra in
+ * other partitions' halos send them their children and new vertices.
+ * @param comm Communicator of the processes
+ * @param cutter Cutter of this process, without journal, vertex sources or cut surface
+ * @param partition Partition of this process
+ * @return Number of tetrahedra that were cut by all processes
+ */
+int cut_mesh(
+    MPI_Comm comm,
+    tetrahedron_mesh_cutter_t& cutter,
+    mesh_partition_t& partition,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line)
+{
+    assert(cutter.journal == nullptr);
+    assert(cutter.vertex_sources == nullptr);
+    assert(cutter.cut_surface == nullptr);
+    cutter.quality = {};
+
+    int rank = 0, size = 0;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    auto& V = partition.V;
+    auto& T = partition.T;
+
+    Eigen::Vector3d const min =
+        start_line.first.cwiseMin(start_line.second).cwiseMin(end_line.second);
+    Eigen::Vector3d const max =
+        start_line.first.cwiseMax(start_line.second).cwiseMax(end_line.second);
+
+    // owned rows in global order, which is the order of a single process cut
+    std::vector<int> owned_rows{};
+    for (int row = 0; row < T.rows(); ++row)
+        if (partition.owners[row] == partition.part)
+            owned_rows.push_back(row);
+    std::sort(owned_rows.begin(), owned_rows.end(), [&](int a, int b) {
+        return partition.global_tetrahedra[a] < partition.global_tetrahedra[b];
+    });
+
+    struct local_cut_t
+    {
+        int row;
+        int first_vertex;
+        int vertex_end;
+        int first_tetrahedron;
+        int tetrahedron_end;
+    };
+
+    // the sources of the new vertices tell the crossed edges and faces they lie on
+    std::vector<vertex_source_t> sources{};
+    cutter.vertex_sources = &sources;
+
+    std::vector<local_cut_t> cuts{};
+    std::vector<int> records{};
+    int const local_vertex_count = static_cast<int>(V.rows());
+    cutter.begin_cut();
+    for (int const row : owned_rows)
+    {
+        Eigen::RowVector3d tmin = V.row(T(row, 0));
+        Eigen::RowVector3d tmax = tmin;
+        for (int j = 1; j < 4; ++j)
+        {
+            tmin = tmin.cwiseMin(V.row(T(row, j)));
+            tmax = tmax.cwiseMax(V.row(T(row, j)));
+        }
+
+        bool const overlaps = (tmin.transpose().array() <= max.array()).all() &&
+                              (tmax.transpose().array() >= min.array()).all();
+        if (!overlaps)
+            continue;
+
+        int const vertex_count      = static_cast<int>(V.rows());
+        int const tetrahedron_count = static_cast<int>(T.rows());
+        if (!cut_tetrahedron(cutter, V, T, row, start_line, end_line))
+            continue;
+
+        cuts.push_back(
+            {row,
+             vertex_count,
+             static_cast<int>(V.rows()),
+             tetrahedron_count,
+             static_cast<int>(T.rows())});
+        records.insert(
+            records.end(),
+            {partition.global_tetrahedra[row], static_cast<int>(T.rows()) - tetrahedron_count});
+    }
+    cutter.end_cut();
+    cutter.vertex_sources = nullptr;
+    assert(static_cast<int>(sources.size()) == V.rows() - local_vertex_count);
+
+    // key of every new vertex: the global vertices of its crossed edge followed by -1, or by -2
+    // for the vertex's fracture copy, or of its crossed face
+    using key_t = std::array<int, 3u>;
+    std::vector<key_t> keys(sources.size());
+    for (std::size_t i = 0u; i < sources.size(); ++i)
+    {
+        vertex_source_t source = sources[i];
+        for (int& parent : source.vertices)
+            if (parent >= 0)
+                parent = partition.global_vertices[parent];
+
+        keys[i] = detail::intersection_key(source);
+        if (source.is_copy())
+            keys[i][2] = -2;
+    }
+
+    // every process' new vertices by key, creating tetrahedron and index among its new vertices
+    std::vector<int> vertex_records{};
+    vertex_records.reserve(6u * sources.size());
+    for (auto const& cut : cuts)
+    {
+        for (int v = cut.first_vertex; v < cut.vertex_end; ++v)
+        {
+            auto const& key = keys[static_cast<std::size_t>(v - local_vertex_count)];
+            vertex_records.insert(
+                vertex_records.end(),
+                {key[0],
+                 key[1],
+                 key[2],
+                 partition.global_tetrahedra[cut.row],
+                 v - cut.first_vertex,
+                 rank});
+        }
+    }
+
+    auto const all_vertex_records = detail::all_gather(comm, vertex_records);
+    auto const all_records        = detail::all_gather(comm, records);
+    int const vertex_record_count = static_cast<int>(all_vertex_records.size() / 6u);
+    int const cut_count           = static_cast<int>(all_records.size() / 2u);
+
+    auto const record_key = [&](int i) {
+        return key_t{
+            all_vertex_records[6 * i],
+            all_vertex_records[6 * i + 1],
+            all_vertex_records[6 * i + 2]};
+    };
+    auto const creation = [&](int i) {
+        return std::make_pair(all_vertex_records[6 * i + 3], all_vertex_records[6 * i + 4]);
+    };
+
+    // records of equal keys, the first creation first
+    std::vector<int> vertex_order(static_cast<std::size_t>(vertex_record_count));
+    std::iota(vertex_order.begin(), vertex_order.end(), 0);
+    std::sort(vertex_order.begin(), vertex_order.end(), [&](int a, int b) {
+        return std::make_pair(record_key(a), creation(a)) <
+               std::make_pair(record_key(b), creation(b));
+    });
+
+    // vertices are numbered in the order of their first creations, as in a single process cut
+    std::vector<int> first_creations{};
+    for (int i = 0; i < vertex_record_count; ++i)
+        if (i == 0 || record_key(vertex_order[i]) != record_key(vertex_order[i - 1]))
+            first_creations.push_back(vertex_order[i]);
+    std::sort(first_creations.begin(), first_creations.end(), [&](int a, int b) {
+        return creation(a) < creation(b);
+    });
+
+    std::vector<std::pair<key_t, int>> global_keys{};
+    global_keys.reserve(first_creations.size());
+    for (std::size_t i = 0u; i < first_creations.size(); ++i)
+    {
+        global_keys.push_back(
+            {record_key(first_creations[i]),
+             partition.global_vertex_count + static_cast<int>(i)});
+    }
+    std::sort(global_keys.begin(), global_keys.end());
+    auto const global_vertex = [&](key_t const& key) {
+        auto const it = std::lower_bound(
+            global_keys.begin(),
+            global_keys.end(),
+            std::make_pair(key, std::numeric_limits<int>::min()));
+        return it->second;
+    };
+
+    // global numbering of the new tetrahedra from the cuts of all processes, in global order
+    std::vector<int> order(static_cast<std::size_t>(cut_count));
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return all_records[2 * a] < all_records[2 * b];
+    });
+
+    std::unordered_map<int, int> first_global_tetrahedra{};
+    int next_tetrahedron = partition.global_tetrahedron_count;
+    for (int const i : order)
+    {
+        first_global_tetrahedra[all_records[2 * i]] = next_tetrahedron;
+        next_tetrahedron += all_records[2 * i + 1];
+    }
+    partition.global_vertex_count += static_cast<int>(first_creations.size());
+    partition.global_tetrahedron_count = next_tetrahedron;
+
+    partition.global_vertices.resize(static_cast<std::size_t>(V.rows()));
+    partition.global_tetrahedra.resize(static_cast<std::size_t>(T.rows()));
+    partition.owners.resize(static_cast<std::size_t>(T.rows()), partition.part);
+
+    for (int v = local_vertex_count; v < V.rows(); ++v)
+    {
+        partition.global_vertices[v] =
+            global_vertex(keys[static_cast<std::size_t>(v - local_vertex_count)]);
+    }
+
+    for (auto const& cut : cuts)
+    {
+        int const first_tetrahedron =
+            first_global_tetrahedra.at(partition.global_tetrahedra[cut.row]);
+        for (int t = cut.first_tetrahedron; t < cut.tetrahedron_end; ++t)
+            partition.global_tetrahedra[t] = first_tetrahedron + (t - cut.first_tetrahedron);
+    }
+
+    std::unordered_map<int, int> local_vertices{};
+    for (int v = 0; v < V.rows(); ++v)
+        local_vertices[partition.global_vertices[v]] = v;
+
+    // vertex exchange: the process creating a vertex first sends its position to the other
+    // processes that created it on a partition boundary
+    std::vector<std::vector<int>> int_sends(static_cast<std::size_t>(size));
+    std::vector<std::vector<double>> double_sends(static_cast<std::size_t>(size));
+    for (int begin = 0; begin < vertex_record_count;)
+    {
+        int end = begin + 1;
+        while (end < vertex_record_count &&
+               record_key(vertex_order[end]) == record_key(vertex_order[begin]))
+            ++end;
+
+        if (all_vertex_records[6 * vertex_order[begin] + 5] == rank)
+        {
+            int const vertex = global_vertex(record_key(vertex_order[begin]));
+            int const v      = local_vertices.at(vertex);
+            for (int i = begin + 1; i < end; ++i)
+            {
+                int const q = all_vertex_records[6 * vertex_order[i] + 5];
+                int_sends[q].push_back(vertex);
+                for (int d = 0; d < 3; ++d)
+                    double_sends[q].push_back(V(v, d));
+            }
+        }
+        begin = end;
+    }
+
+    {
+        auto const int_receives    = detail::exchange(comm, int_sends);
+        auto const double_receives = detail::exchange(comm, double_sends);
+        for (int q = 0; q < size; ++q)
+        {
+            for (std::size_t i = 0u; i < int_receives[q].size(); ++i)
+            {
+                int const v = local_vertices.at(int_receives[q][i]);
+                for (int d = 0; d < 3; ++d)
+                    V(v, d) = double_receives[q][3u * i + d];
+            }
+        }
+    }
+
+    // halo exchange: children and new vertices of the cut tetrahedra in other partitions' halos
+    for (int q = 0; q < size; ++q)
+    {
+        int_sends[q].clear();
+        double_sends[q].clear();
+
+        auto& rows = partition.halo_rows[q];
+        if (rows.empty())
+            continue;
+
+        std::sort(rows.begin(), rows.end());
+        std::size_t const halo_count = rows.size();
+        for (auto const& cut : cuts)
+        {
+            if (!std::binary_search(rows.begin(), rows.begin() + halo_count, cut.row))
+                continue;
+
+            // the children's new vertices, including those shared with earlier cuts, which the
+            // receiver skips if it knows them already
+            std::vector<int> new_vertices{};
+            auto const add_new_vertices = [&](int t) {
+                for (int j = 0; j < 4; ++j)
+                    if (T(t, j) >= local_vertex_count)
+                        new_vertices.push_back(T(t, j));
+            };
+            add_new_vertices(cut.row);
+            for (int t = cut.first_tetrahedron; t < cut.tetrahedron_end; ++t)
+                add_new_vertices(t);
+            std::sort(new_vertices.begin(), new_vertices.end());
+            new_vertices.erase(
+                std::unique(new_vertices.begin(), new_vertices.end()),
+                new_vertices.end());
+
+            auto& ints = int_sends[q];
+            ints.push_back(partition.global_tetrahedra[cut.row]);
+            ints.push_back(cut.tetrahedron_end - cut.first_tetrahedron + 1);
+            ints.push_back(static_cast<int>(new_vertices.size()));
+            for (int const v : new_vertices)
+            {
+                ints.push_back(partition.global_vertices[v]);
+                for (int d = 0; d < 3; ++d)
+                    double_sends[q].push_back(V(v, d));
+            }
+
+            auto const send_child = [&](int t) {
+                ints.push_back(partition.global_tetrahedra[t]);
+                for (int j = 0; j < 4; ++j)
+                    ints.push_back(partition.global_vertices[T(t, j)]);
+            };
+            send_child(cut.row);
+            for (int t = cut.first_tetrahedron; t < cut.tetrahedron_end; ++t)
+            {
+                send_child(t);
+                rows.push_back(t);
+            }
+        }
+    }
+
+    auto const int_receives    = detail::exchange(comm, int_sends);
+    auto const double_receives = detail::exchange(comm, double_sends);
+
+    std::unordered_map<int, int> local_halo_rows{};
+    for (int row = 0; row < T.rows(); ++row)
+        if (partition.owners[row] != partition.part)
+            local_halo_rows[partition.global_tetrahedra[row]] = row;
+
+    for (int q = 0; q < size; ++q)
+    {
+        auto const& ints    = int_receives[q];
+        auto const& doubles = double_receives[q];
+        std::size_t i = 0u, k = 0u;
+        while (i < ints.size())
+        {
+            int const row              = local_halo_rows.at(ints[i]);
+            int const child_count      = ints[i + 1u];
+            int const new_vertex_count = ints[i + 2u];
+            i += 3u;
+
+            int unknown_vertex_count = 0;
+            for (int n = 0; n < new_vertex_count; ++n)
+                if (local_vertices.count(ints[i + n]) == 0u)
+                    ++unknown_vertex_count;
+
+            int v = static_cast<int>(V.rows());
+            V.conservativeResize(v + unknown_vertex_count, Eigen::NoChange);
+            for (int n = 0; n < new_vertex_count; ++n, ++i, k += 3u)
+            {
+                if (local_vertices.count(ints[i]) != 0u)
+                    continue;
+
+                local_vertices[ints[i]] = v;
+                partition.global_vertices.push_back(ints[i]);
+                for (int d = 0; d < 3; ++d)
+                    V(v, d) = doubles[k + d];
+                ++v;
+            }
+
+            int const first_tetrahedron = static_cast<int>(T.rows());
+            T.conservativeResize(first_tetrahedron + child_count - 1, Eigen::NoChange);
+            for (int c = 0; c < child_count; ++c)
+            {
+                int const t = c == 0 ? row : first_tetrahedron + c - 1;
+                if (c > 0)
+                {
+                    partition.global_tetrahedra.push_back(ints[i]);
+                    partition.owners.push_back(q);
+                }
+                ++i;
+                for (int j = 0; j < 4; ++j)
+                    T(t, j) = local_vertices.at(ints[i++]);
+            }
+        }
+    }
+
+    // local vertex order follows global vertex order, such that processes split the quadrilaterals
+    // of later cuts along the same diagonals
+    detail::sort_partition_vertices(partition);
+    return cut_count;
+}
+
+/**
+ * @brief
+ * Gathers the owned tetrahedra of all partitions and their vertices into the global mesh (V,T)
+ * on the root process. Must be called by all processes of comm.
+ * @param comm Communicator of the processes
+ * @param partition Partition of this process
+ * @param V Vertex positions, only written on the root process
+ * @param T Tetrahedra, only written on the root process
+ * @param root Process receiving the mesh
+ */
+void gather_mesh(
+    MPI_Comm comm,
+    mesh_partition_t const& partition,
+    Eigen::MatrixXd& V,
+    Eigen::MatrixXi& T,
+    int root = 0)
+{
+    int rank = 0, size = 0;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    // owned tetrahedra as global index and global vertices, and their vertices
+    std::vector<int> tetrahedra{}, vertices{};
+    std::vector<double> positions{};
+    std::vector<std::uint8_t> is_sent(static_cast<std::size_t>(partition.V.rows()), 0u);
+    for (int row = 0; row < partition.T.rows(); ++row)
+    {
+        if (partition.owners[row] != partition.part)
+            continue;
+
+        tetrahedra.push_back(partition.global_tetrahedra[row]);
+        for (int j = 0; j < 4; ++j)
+        {
+            int const v = partition.T(row, j);
+            tetrahedra.push_back(partition.global_vertices[v]);
+            if (is_sent[v] != 0u)
+                continue;
+
+            is_sent[v] = 1u;
+            vertices.push_back(partition.global_vertices[v]);
+            for (int d = 0; d < 3; ++d)
+                positions.push_back(partition.V(v, d));
+        }
+    }
+
+    if (rank != root)
+    {
+        detail::send_vector(comm, tetrahedra, root);
+        detail::send_vector(comm, vertices, root);
+        detail::send_vector(comm, positions, root);
+        return;
+    }
+
+    V.setZero(partition.global_vertex_count, 3);
+    T.setZero(partition.global_tetrahedron_count, 4);
+
+    auto const write = [&](std::vector<int> const& part_tetrahedra,
+                           std::vector<int> const& part_vertices,
+                           std::vector<double> const& part_positions) {
+        for (std::size_t i = 0u; i < part_tetrahedra.size(); i += 5u)
+            for (int j = 0; j < 4; ++j)
+                T(part_tetrahedra[i], j) = part_tetrahedra[i + 1u + j];
+        for (std::size_t i = 0u; i < part_vertices.size(); ++i)
+            for (int d = 0; d < 3; ++d)
+                V(part_vertices[i], d) = part_positions[3u * i + d];
+    };
+
+    // the root's own rows are written from its local buffers, which receiving must not overwrite
+    write(tetrahedra, vertices, positions);
+    for (int q = 0; q < size; ++q)
+    {
+        if (q == root)
+            continue;
+
+        std::vector<int> const received_tetrahedra   = detail::receive_vector<int>(comm, q);
+        std::vector<int> const received_vertices     = detail::receive_vector<int>(comm, q);
+        std::vector<double> const received_positions = detail::receive_vector<double>(comm, q);
+        write(received_tetrahedra, received_vertices, received_positions);
+    }
+}
+
+} // namespace geometry
+
+#endif // TET_CUT_DISTRIBUTED_CUT_HPP
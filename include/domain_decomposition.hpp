@@ -0,0 +1,240 @@
+#ifndef TET_CUT_DOMAIN_DECOMPOSITION_HPP
+#define TET_CUT_DOMAIN_DECOMPOSITION_HPP
+
+#include "mesh_reordering.hpp"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cstdint>
+#include <igl/parallel_for.h>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Part of a mesh owned by one process of a domain decomposition, together with a halo layer of
+ * the tetrahedra of other partitions that share a vertex with an owned tetrahedron. Local
+ * vertices are sorted by global index, such that local tetrahedra keep the relative vertex order
+ * of their global counterparts.
+ */
+struct mesh_partition_t
+{
+    // local vertex positions and tetrahedra, indexing local vertices
+    Eigen::MatrixXd V{};
+    Eigen::MatrixXi T{};
+
+    // global index of every local vertex and tetrahedron
+    std::vector<int> global_vertices{};
+    std::vector<int> global_tetrahedra{};
+
+    // partition owning every local tetrahedron
+    std::vector<int> owners{};
+
+    // local rows of the owned tetrahedra in the halo of every partition
+    std::vector<std::vector<int>> halo_rows{};
+
+    int part{0};
+    int global_vertex_count{0};
+    int global_tetrahedron_count{0};
+};
+
+/**
+ * @brief
+ * Assigns every tetrahedron to one of part_count partitions by splitting the Morton curve through
+ * the tetrahedron barycenters into contiguous pieces of equal size
+ * @return Partition of every tetrahedron
+ */
+std::vector<int> partition_tetrahedra(
+    Eigen::MatrixXd const& V,
+    Eigen::MatrixXi const& T,
+    int part_count)
+{
+    Eigen::MatrixXd B(T.rows(), 3);
+    igl::parallel_for(
+        T.rows(),
+        [&](Eigen::Index t) {
+            B.row(t) = 0.25 * (V.row(T(t, 0)) + V.row(T(t, 1)) + V.row(T(t, 2)) + V.row(T(t, 3)));
+        },
+        1000u);
+
+    auto const order = detail::parallel_argsort(detail::morton_codes(B));
+
+    std::vector<int> parts(order.size());
+    auto const n = static_cast<std::int64_t>(order.size());
+    for (std::int64_t i = 0; i < n; ++i)
+        parts[order[i]] = static_cast<int>(i * part_count / n);
+
+    return parts;
+}
+
+namespace detail {
+
+/**
+ * @brief
+ * Partitions owning a tetrahedron incident to every vertex of the mesh (V,T), in compressed rows
+ * of keys vertex * part_count + part
+ */
+struct vertex_parts_t
+{
+    std::vector<std::int64_t> keys{};
+    std::vector<int> first_keys{};
+    int part_count{0};
+
+    template <class F>
+    void for_each_part(int v, F const& f) const
+    {
+        for (int i = first_keys[v]; i < first_keys[v + 1]; ++i)
+            f(static_cast<int>(keys[i] % part_count));
+    }
+};
+
+vertex_parts_t find_vertex_parts(
+    Eigen::MatrixXd const& V,
+    Eigen::MatrixXi const& T,
+    std::vector<int> const& parts,
+    int part_count)
+{
+    int const vertex_count      = static_cast<int>(V.rows());
+    int const tetrahedron_count = static_cast<int>(T.rows());
+
+    vertex_parts_t vertex_parts{};
+    vertex_parts.part_count = part_count;
+
+    auto& keys = vertex_parts.keys;
+    keys.reserve(4u * parts.size());
+    for (int t = 0; t < tetrahedron_count; ++t)
+        for (int j = 0; j < 4; ++j)
+            keys.push_back(std::int64_t{T(t, j)} * part_count + parts[t]);
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    auto& first_keys = vertex_parts.first_keys;
+    first_keys.assign(static_cast<std::size_t>(vertex_count) + 1u, 0);
+    for (auto const key : keys)
+        ++first_keys[static_cast<std::size_t>(key / part_count) + 1u];
+    for (int v = 0; v < vertex_count; ++v)
+        first_keys[v + 1] += first_keys[v];
+
+    return vertex_parts;
+}
+
+/**
+ * @brief
+ * Extracts partition p with its halo layer from the mesh (V,T), see partition_mesh
+ */
+mesh_partition_t extract_partition(
+    Eigen::MatrixXd const& V,
+    Eigen::MatrixXi const& T,
+    std::vector<int> const& parts,
+    vertex_parts_t const& vertex_parts,
+    int p)
+{
+    int const part_count        = vertex_parts.part_count;
+    int const tetrahedron_count = static_cast<int>(T.rows());
+
+    mesh_partition_t partition{};
+    partition.part                     = p;
+    partition.global_vertex_count      = static_cast<int>(V.rows());
+    partition.global_tetrahedron_count = tetrahedron_count;
+    partition.halo_rows.resize(static_cast<std::size_t>(part_count));
+
+    std::vector<int> halo{};
+    for (int t = 0; t < tetrahedron_count; ++t)
+    {
+        if (parts[t] == p)
+        {
+            partition.global_tetrahedra.push_back(t);
+            continue;
+        }
+
+        bool is_halo = false;
+        for (int j = 0; j < 4 && !is_halo; ++j)
+            vertex_parts.for_each_part(T(t, j), [&](int q) { is_halo = is_halo || q == p; });
+        if (is_halo)
+            halo.push_back(t);
+    }
+
+    auto& tetrahedra      = partition.global_tetrahedra;
+    int const owned_count = static_cast<int>(tetrahedra.size());
+    tetrahedra.insert(tetrahedra.end(), halo.begin(), halo.end());
+    partition.owners.resize(tetrahedra.size(), p);
+
+    auto& vertices = partition.global_vertices;
+    for (int const t : tetrahedra)
+        for (int j = 0; j < 4; ++j)
+            vertices.push_back(T(t, j));
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+    auto const local_vertex = [&](int v) {
+        return static_cast<int>(
+            std::lower_bound(vertices.begin(), vertices.end(), v) - vertices.begin());
+    };
+
+    int const local_count = static_cast<int>(tetrahedra.size());
+    partition.V.resize(static_cast<Eigen::Index>(vertices.size()), 3);
+    partition.T.resize(local_count, 4);
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+        partition.V.row(static_cast<Eigen::Index>(i)) = V.row(vertices[i]);
+
+    for (int row = 0; row < local_count; ++row)
+    {
+        int const t = tetrahedra[row];
+        for (int j = 0; j < 4; ++j)
+            partition.T(row, j) = local_vertex(T(t, j));
+
+        if (row >= owned_count)
+        {
+            partition.owners[row] = parts[t];
+            continue;
+        }
+
+        // an owned tetrahedron is in the halo of every other partition sharing one of its
+        // vertices
+        std::vector<int> neighbours{};
+        for (int j = 0; j < 4; ++j)
+            vertex_parts.for_each_part(T(t, j), [&](int q) {
+                if (q != p)
+                    neighbours.push_back(q);
+            });
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+        for (int const q : neighbours)
+            partition.halo_rows[q].push_back(row);
+    }
+
+    return partition;
+}
+
+} // namespace detail
+
+/**
+ * @brief
+ * Splits the mesh (V,T) into part_count partitions with halo layers. Owned tetrahedra come first
+ * in every partition's T and are sorted by global index, followed by the halo tetrahedra.
+ * @param V Vertex positions
+ * @param T Tetrahedra
+ * @param parts Partition of every tetrahedron, see partition_tetrahedra
+ * @param part_count Number of partitions
+ * @return Partitions 0,...,part_count-1
+ */
+std::vector<mesh_partition_t> partition_mesh(
+    Eigen::MatrixXd const& V,
+    Eigen::MatrixXi const& T,
+    std::vector<int> const& parts,
+    int part_count)
+{
+    auto const vertex_parts = detail::find_vertex_parts(V, T, parts, part_count);
+
+    std::vector<mesh_partition_t> partitions(static_cast<std::size_t>(part_count));
+    igl::parallel_for(part_count, [&](int p) {
+        partitions[p] = detail::extract_partition(V, T, parts, vertex_parts, p);
+    });
+
+    return partitions;
+}
+
+} // namespace geometry
+
+#endif // TET_CUT_DOMAIN_DECOMPOSITION_HPP
@@ -0,0 +1,354 @@
+#ifndef TET_CUT_EMBEDDED_SURFACE_HPP
+#define TET_CUT_EMBEDDED_SURFACE_HPP
+
+#include "attribute_transfer.hpp"
+#include "cut_journal.hpp"
+#include "intersection_tests.hpp"
+#include "level_set_cut.hpp"
+#include "mesh_primitives.hpp"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <igl/parallel_for.h>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Surface mesh embedded in a tetrahedral mesh, e.g. a high resolution render surface driven by
+ * coarse simulation tetrahedra. Every surface vertex is stored as the tetrahedron containing it
+ * and its barycentric coordinates, such that its position follows the tetrahedral mesh as it
+ * deforms.
+ *
+ * After a cut, update follows every subdivided tetrahedron to its children, so only the surface
+ * vertices embedded in the cut region are relocated, and splits the surface triangles crossing
+ * the cutting triangle. Surface triangles are assumed to be small compared to the tetrahedra,
+ * such that a triangle crossing the cut has a vertex embedded in a subdivided tetrahedron.
+ */
+class embedded_surface_t
+{
+  public:
+    embedded_surface_t() = default;
+
+    /**
+     * @brief
+     * @param F Surface triangles
+     * @param tetrahedra Row of T of the tetrahedron containing every surface vertex
+     * @param barycentric Barycentric coordinates of every surface vertex in its tetrahedron
+     */
+    embedded_surface_t(
+        Eigen::MatrixXi const& F,
+        Eigen::VectorXi const& tetrahedra,
+        Eigen::MatrixXd const& barycentric)
+        : F_{F}, tetrahedra_{tetrahedra}, barycentric_{barycentric}
+    {
+        assert(tetrahedra_.size() == barycentric_.rows());
+
+        for (int v = 0; v < vertex_count(); ++v)
+            tetrahedron_vertices_[tetrahedra_(v)].push_back(v);
+
+        vertex_triangles_.resize(static_cast<std::size_t>(vertex_count()));
+        for (int f = 0; f < F_.rows(); ++f)
+            for (int j = 0; j < 3; ++j)
+                vertex_triangles_[F_(f, j)].push_back(f);
+    }
+
+    int vertex_count() const { return static_cast<int>(tetrahedra_.size()); }
+    Eigen::MatrixXi const& faces() const { return F_; }
+    Eigen::VectorXi const& tetrahedra() const { return tetrahedra_; }
+    Eigen::MatrixXd const& barycentric() const { return barycentric_; }
+
+    /**
+     * @brief
+     * Position of surface vertex v in the tetrahedral mesh (V,T)
+     */
+    Eigen::RowVector3d position(Eigen::MatrixXd const& V, Eigen::MatrixXi const& T, int v) const
+    {
+        Eigen::RowVector3d position = Eigen::RowVector3d::Zero();
+        for (int j = 0; j < 4; ++j)
+            position += barycentric_(v, j) * V.row(T(tetrahedra_(v), j));
+        return position;
+    }
+
+    /**
+     * @brief
+     * Positions of all surface vertices in the tetrahedral mesh (V,T), computed in parallel
+     */
+    Eigen::MatrixXd positions(Eigen::MatrixXd const& V, Eigen::MatrixXi const& T) const
+    {
+        Eigen::MatrixXd P(vertex_count(), 3);
+        igl::parallel_for(
+            vertex_count(),
+            [&](int v) { P.row(v) = position(V, T, v); },
+            1000u);
+        return P;
+    }
+
+    /**
+     * @brief
+     * Updates the embedding after a cut of the tetrahedral mesh (V,T) by the triangle formed by
+     * start_line and end_line, whose subdivisions were recorded in delta. Surface vertices in
+     * subdivided tetrahedra are moved to the child containing them, and surface triangles with
+     * two edges crossing the cutting triangle are split into three along the crossings. The
+     * crossings are shared by the triangles on both sides of the crossed edge.
+     * @param delta Changes made by the cut, cleared since the previous update
+     * @param separate True if the cut fractured the mesh, in which case every crossing is
+     * created twice, once embedded on either side of the cutting surface, such that the surface
+     * separates along with the tetrahedra
+     * @param vertex_sources If not null, the sources of the new surface vertices are appended to
+     * it, interpolating the endpoints of the crossed edge
+     * @return Number of split surface triangles
+     */
+    int update(
+        Eigen::MatrixXd const& V,
+        Eigen::MatrixXi const& T,
+        cut_delta_t const& delta,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line,
+        bool separate                                = false,
+        std::vector<vertex_source_t>* vertex_sources = nullptr)
+    {
+        // rows holding the children of every subdivision, and the subdivision of every such row
+        std::unordered_map<int, int> row_records{};
+        auto const& records = delta.records();
+        for (int r = 0; r < static_cast<int>(records.size()); ++r)
+        {
+            for_each_child(records[r], [&](int t) { row_records[t] = r; });
+            relocate(V, T, records[r]);
+        }
+
+        Eigen::Vector3d const& a     = start_line.first;
+        Eigen::Vector3d const& b     = start_line.second;
+        Eigen::Vector3d const& c     = end_line.second;
+        Eigen::Vector3d const normal = (b - a).cross(c - a);
+
+        auto const is_negative = [&](Eigen::RowVector3d const& p) {
+            return normal.dot(p.transpose() - a) < 0.;
+        };
+        auto const is_negative_tetrahedron = [&](int t) {
+            return is_negative(
+                0.25 * (V.row(T(t, 0)) + V.row(T(t, 1)) + V.row(T(t, 2)) + V.row(T(t, 3))));
+        };
+
+        // the tetrahedron containing p, among the children of the subdivisions that produced the
+        // tetrahedra of the given surface vertices, or else among all children
+        auto const locate =
+            [&](Eigen::RowVector3d const& p, std::array<int, 2u> const& vertices, int side) {
+                std::pair<int, Eigen::RowVector4d> best{-1, Eigen::RowVector4d::Zero()};
+                double best_min = -std::numeric_limits<double>::infinity();
+                auto const visit = [&](int t) {
+                    if (side >= 0 && is_negative_tetrahedron(t) != (side == 0))
+                        return;
+
+                    Eigen::RowVector4d const coordinates =
+                        detail::tetrahedron_barycentric_coordinates(p, V, T.row(t));
+                    if (coordinates.minCoeff() > best_min)
+                    {
+                        best     = {t, coordinates};
+                        best_min = coordinates.minCoeff();
+                    }
+                };
+
+                for (int const v : vertices)
+                {
+                    auto const it = row_records.find(tetrahedra_(v));
+                    if (it != row_records.end())
+                        for_each_child(records[it->second], visit);
+                    else
+                        visit(tetrahedra_(v));
+                }
+
+                double constexpr tolerance = 1e-9;
+                if (best_min < -tolerance)
+                    for (auto const& record : records)
+                        for_each_child(record, visit);
+
+                return best;
+            };
+
+        // triangles incident to relocated vertices
+        std::vector<int> triangles{};
+        for (int const v : relocated_)
+        {
+            auto const& incident = vertex_triangles_[v];
+            triangles.insert(triangles.end(), incident.begin(), incident.end());
+        }
+        std::sort(triangles.begin(), triangles.end());
+        triangles.erase(std::unique(triangles.begin(), triangles.end()), triangles.end());
+        relocated_.clear();
+
+        // intersections of surface edges with the cutting triangle, computed from the edge's
+        // lower vertex index such that both triangles sharing the edge agree
+        std::unordered_map<std::uint64_t, line_triangle_intersection_t> intersections{};
+        auto const intersect = [&](int vi, int vj) -> line_triangle_intersection_t const& {
+            std::uint64_t const key = detail::edge_key(vi, vj);
+            auto it                 = intersections.find(key);
+            if (it == intersections.end())
+            {
+                Eigen::Vector3d const p = position(V, T, std::min(vi, vj)).transpose();
+                Eigen::Vector3d const q = position(V, T, std::max(vi, vj)).transpose();
+                it = intersections.emplace(key, intersect_triangle_line_two_way(a, b, c, {p, q}))
+                         .first;
+            }
+            return it->second;
+        };
+
+        // crossings of surface edges, on the negative and positive side of the cutting surface
+        std::unordered_map<std::uint64_t, std::array<int, 2u>> crossings{};
+        auto const crossing = [&](int vi, int vj) {
+            auto const inserted = crossings.insert({detail::edge_key(vi, vj), {}});
+            auto& vertices      = inserted.first->second;
+            if (!inserted.second)
+                return vertices;
+
+            int const lo            = std::min(vi, vj);
+            int const hi            = std::max(vi, vj);
+            auto const intersection = intersect(lo, hi);
+            for (int side = 0; side < (separate ? 2 : 1); ++side)
+            {
+                Eigen::RowVector3d const p = intersection.point.transpose();
+                auto located               = locate(p, {lo, hi}, separate ? side : -1);
+                if (located.first < 0)
+                    located = {tetrahedra_(lo), barycentric_.row(lo)};
+                vertices[side] = add_vertex(located.first, located.second);
+
+                if (vertex_sources != nullptr)
+                {
+                    vertex_sources->push_back(
+                        {vertices[side], {lo, hi, -1}, {1. - intersection.t, intersection.t, 0.}});
+                }
+            }
+            if (!separate)
+                vertices[1] = vertices[0];
+
+            return vertices;
+        };
+
+        int split_count = 0;
+        for (int const f : triangles)
+        {
+            std::array<bool, 3u> is_crossed{};
+            int crossed_count = 0;
+            for (int j = 0; j < 3; ++j)
+            {
+                is_crossed[j] = intersect(F_(f, j), F_(f, (j + 1) % 3)).intersects;
+                crossed_count += is_crossed[j] ? 1 : 0;
+            }
+
+            // triangles in which the cut ends are left unsplit
+            if (crossed_count != 2)
+                continue;
+
+            // the vertex shared by both crossed edges is alone on its side
+            int const k     = !is_crossed[0] ? 2 : !is_crossed[1] ? 0 : 1;
+            int const lone  = F_(f, k);
+            int const next  = F_(f, (k + 1) % 3);
+            int const last  = F_(f, (k + 2) % 3);
+            int const side  = is_negative(position(V, T, lone)) ? 0 : 1;
+            auto const x    = crossing(lone, next);
+            auto const y    = crossing(last, lone);
+            int const first = static_cast<int>(F_.rows());
+            F_.conservativeResize(F_.rows() + 2, Eigen::NoChange);
+            F_.row(f)         = Eigen::RowVector3i{lone, x[side], y[side]};
+            F_.row(first)     = Eigen::RowVector3i{x[1 - side], next, last};
+            F_.row(first + 1) = Eigen::RowVector3i{x[1 - side], last, y[1 - side]};
+
+            unlink(next, f);
+            unlink(last, f);
+            for (int const row : {f, first, first + 1})
+                for (int j = 0; j < 3; ++j)
+                    if (row != f || j != 0)
+                        vertex_triangles_[F_(row, j)].push_back(row);
+
+            ++split_count;
+        }
+
+        return split_count;
+    }
+
+  private:
+    template <class Visit>
+    static void for_each_child(cut_record_t const& record, Visit const& visit)
+    {
+        visit(record.tetrahedron);
+        int const end = record.first_appended_tetrahedron + record.appended_tetrahedron_count;
+        for (int t = record.first_appended_tetrahedron; t < end; ++t)
+            visit(t);
+    }
+
+    // moves the surface vertices of a subdivided tetrahedron to the children containing them
+    void relocate(Eigen::MatrixXd const& V, Eigen::MatrixXi const& T, cut_record_t const& record)
+    {
+        auto const it = tetrahedron_vertices_.find(record.tetrahedron);
+        if (it == tetrahedron_vertices_.end())
+            return;
+
+        std::vector<int> const vertices = std::move(it->second);
+        tetrahedron_vertices_.erase(it);
+
+        for (int const v : vertices)
+        {
+            Eigen::RowVector3d p = Eigen::RowVector3d::Zero();
+            for (int j = 0; j < 4; ++j)
+                p += barycentric_(v, j) * V.row(record.replaced_tetrahedron(j));
+
+            int child              = record.tetrahedron;
+            Eigen::RowVector4d best = Eigen::RowVector4d::Constant(
+                -std::numeric_limits<double>::infinity());
+            for_each_child(record, [&](int t) {
+                Eigen::RowVector4d const coordinates =
+                    detail::tetrahedron_barycentric_coordinates(p, V, T.row(t));
+                if (coordinates.minCoeff() > best.minCoeff())
+                {
+                    child = t;
+                    best  = coordinates;
+                }
+            });
+
+            tetrahedra_(v)      = child;
+            barycentric_.row(v) = best;
+            tetrahedron_vertices_[child].push_back(v);
+            relocated_.push_back(v);
+        }
+    }
+
+    int add_vertex(int tetrahedron, Eigen::RowVector4d const& barycentric)
+    {
+        int const v = vertex_count();
+        tetrahedra_.conservativeResize(v + 1);
+        barycentric_.conservativeResize(v + 1, 4);
+        tetrahedra_(v)      = tetrahedron;
+        barycentric_.row(v) = barycentric;
+        tetrahedron_vertices_[tetrahedron].push_back(v);
+        vertex_triangles_.emplace_back();
+        return v;
+    }
+
+    void unlink(int v, int f)
+    {
+        auto& triangles = vertex_triangles_[v];
+        triangles.erase(std::find(triangles.begin(), triangles.end(), f));
+    }
+
+    Eigen::MatrixXi F_{};
+    Eigen::VectorXi tetrahedra_{};
+    Eigen::MatrixXd barycentric_{};
+
+    // surface vertices embedded in every tetrahedron, and surface triangles of every vertex
+    std::unordered_map<int, std::vector<int>> tetrahedron_vertices_{};
+    std::vector<std::vector<int>> vertex_triangles_{};
+
+    // surface vertices relocated by the current update
+    std::vector<int> relocated_{};
+};
+
+} // namespace geometry
+
+#endif // TET_CUT_EMBEDDED_SURFACE_HPP
@@ -2,20 +2,36 @@
 #define TET_CUT_INTERSECTION_TESTS_HPP
 
 #include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <utility>
 
 namespace geometry {
 
 /**
  * @brief
- * Computes intersection point, if any, of a triangle ABC in counterclockwise order and a finite
- * line segment
+ * Intersection of a triangle ABC and a line segment pq. The intersection point is (1-t)p + tq on
+ * the segment, and u*A + v*B + w*C on the triangle.
+ */
+struct line_triangle_intersection_t
+{
+    bool intersects{false};
+    Eigen::Vector3d point{};
+    double t{0.};
+    Eigen::Vector3d barycentric{};
+};
+
+/**
+ * @brief
+ * Computes intersection, if any, of a triangle ABC in counterclockwise order and a finite line
+ * segment, along with the segment parameter and triangle barycentric coordinates of the
+ * intersection point
  * @param a Vertex 1
  * @param b Vertex 2
  * @param c Vertex 3
  * @param line Line segment as a pair of points (p,q)
- * @return Pair of intersection success boolean and intersection point (if any)
+ * @return Intersection
  */
-std::pair<bool, Eigen::Vector3d> triangle_line_intersection(
+line_triangle_intersection_t intersect_triangle_line(
     Eigen::Vector3d const& a,
     Eigen::Vector3d const& b,
     Eigen::Vector3d const& c,
@@ -31,49 +47,80 @@ std::pair<bool, Eigen::Vector3d> triangle_line_intersection(
 
     double const d = qp.dot(n);
     if (d <= 0.)
-        return {false, {}};
+        return {};
 
     Eigen::Vector3d const ap = p - a;
 
     double t = ap.dot(n);
     if (t < 0.)
-        return {false, {}};
+        return {};
     if (t > d)
-        return {false, {}};
+        return {};
 
     Eigen::Vector3d const e = qp.cross(ap);
 
     double v = ac.dot(e);
     if (v < 0. || v > d)
-        return {false, {}};
+        return {};
 
     double w = -ab.dot(e);
     if (w < 0. || (v + w) > d)
-        return {false, {}};
+        return {};
 
     double const ood = 1. / d;
     t *= ood;
-    // v *= ood;
-    // w *= ood;
-    // double const u = 1. - v - w;
+    v *= ood;
+    w *= ood;
+    double const u = 1. - v - w;
 
     Eigen::Vector3d const intersection = (1. - t) * p + t * q;
-    return {true, intersection};
+    return {true, intersection, t, {u, v, w}};
 }
 
-std::pair<bool, Eigen::Vector3d> triangle_line_intersection_two_way(
+line_triangle_intersection_t intersect_triangle_line_two_way(
     Eigen::Vector3d const& a,
     Eigen::Vector3d const& b,
     Eigen::Vector3d const& c,
     std::pair<Eigen::Vector3d, Eigen::Vector3d> const& line)
 {
-    auto const [has_intersection_1, intersection_1] = triangle_line_intersection(a, b, c, line);
-    auto const [has_intersection_2, intersection_2] = triangle_line_intersection(b, a, c, line);
+    auto const intersection_1 = intersect_triangle_line(a, b, c, line);
+    if (intersection_1.intersects)
+        return intersection_1;
+
+    // barycentric coordinates of BAC are reordered to those of ABC
+    auto intersection_2 = intersect_triangle_line(b, a, c, line);
+    std::swap(intersection_2.barycentric(0), intersection_2.barycentric(1));
+    return intersection_2;
+}
 
-    if (has_intersection_1)
-        return {has_intersection_1, intersection_1};
+/**
+ * @brief
+ * Computes intersection point, if any, of a triangle ABC in counterclockwise order and a finite
+ * line segment
+ * @param a Vertex 1
+ * @param b Vertex 2
+ * @param c Vertex 3
+ * @param line Line segment as a pair of points (p,q)
+ * @return Pair of intersection success boolean and intersection point (if any)
+ */
+std::pair<bool, Eigen::Vector3d> triangle_line_intersection(
+    Eigen::Vector3d const& a,
+    Eigen::Vector3d const& b,
+    Eigen::Vector3d const& c,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& line)
+{
+    auto const intersection = intersect_triangle_line(a, b, c, line);
+    return {intersection.intersects, intersection.point};
+}
 
-    return {has_intersection_2, intersection_2};
+std::pair<bool, Eigen::Vector3d> triangle_line_intersection_two_way(
+    Eigen::Vector3d const& a,
+    Eigen::Vector3d const& b,
+    Eigen::Vector3d const& c,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& line)
+{
+    auto const intersection = intersect_triangle_line_two_way(a, b, c, line);
+    return {intersection.intersects, intersection.point};
 }
 
 } // namespace geometry
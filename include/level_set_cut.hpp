@@ -0,0 +1,297 @@
+#ifndef TET_CUT_LEVEL_SET_CUT_HPP
+#define TET_CUT_LEVEL_SET_CUT_HPP
+
+#include "cut_tetrahedron.hpp"
+#include "mesh_primitives.hpp"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <igl/parallel_for.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Signed distance function sampled on a regular grid and trilinearly interpolated. Samples are
+ * stored with x varying fastest, and queries outside of the grid are clamped to its boundary.
+ */
+struct sampled_signed_distance_t
+{
+    Eigen::Vector3d origin{0., 0., 0.};
+    Eigen::Vector3d spacing{1., 1., 1.};
+    Eigen::Vector3i dimensions{0, 0, 0};
+    Eigen::VectorXd values{};
+
+    double value(int i, int j, int k) const
+    {
+        return values(i + dimensions(0) * (j + dimensions(1) * k));
+    }
+
+    double operator()(Eigen::Vector3d const& p) const
+    {
+        assert((dimensions.array() >= 2).all());
+
+        std::array<int, 3u> i{};
+        std::array<double, 3u> w{};
+        for (int d = 0; d < 3; ++d)
+        {
+            double const q = std::clamp(
+                (p(d) - origin(d)) / spacing(d),
+                0.,
+                static_cast<double>(dimensions(d) - 1));
+            i[d] = std::min(static_cast<int>(q), dimensions(d) - 2);
+            w[d] = q - static_cast<double>(i[d]);
+        }
+
+        double result = 0.;
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            int const dx = corner & 1;
+            int const dy = (corner >> 1) & 1;
+            int const dz = (corner >> 2) & 1;
+
+            double const weight = (dx ? w[0] : 1. - w[0]) * (dy ? w[1] : 1. - w[1]) *
+                                  (dz ? w[2] : 1. - w[2]);
+            result += weight * value(i[0] + dx, i[1] + dy, i[2] + dz);
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief
+ * Root finding parameters for the edge crossings of a level set
+ */
+struct level_set_parameters_t
+{
+    int max_iterations{32};
+    double tolerance{1e-12};
+};
+
+/**
+ * @brief
+ * Evaluates the signed distance function phi at every vertex of V in parallel
+ * @param V Vertex positions
+ * @param phi Callable taking an Eigen::Vector3d and returning a double
+ * @return Signed distance of every vertex
+ */
+template <class SignedDistance>
+Eigen::VectorXd evaluate_level_set(Eigen::MatrixXd const& V, SignedDistance const& phi)
+{
+    Eigen::VectorXd values(V.rows());
+    igl::parallel_for(
+        V.rows(),
+        [&](Eigen::Index i) { values(i) = phi(V.row(i).transpose()); },
+        1000u);
+    return values;
+}
+
+namespace detail {
+
+/**
+ * @brief
+ * Finds the zero crossing of phi along the segment from p0 to p1, where phi(p0) = f0 and
+ * phi(p1) = f1 have opposite signs, with the Illinois variant of regula falsi
+ * @return Parameter t in [0,1] of the crossing p0 + t(p1-p0)
+ */
+template <class SignedDistance>
+double find_edge_root(
+    SignedDistance const& phi,
+    Eigen::Vector3d const& p0,
+    Eigen::Vector3d const& p1,
+    double f0,
+    double f1,
+    level_set_parameters_t const& parameters)
+{
+    double t0 = 0.;
+    double t1 = 1.;
+    double t  = f0 / (f0 - f1);
+
+    int side = 0;
+    for (int i = 0; i < parameters.max_iterations; ++i)
+    {
+        double const f = phi(p0 + t * (p1 - p0));
+        if (std::abs(f) <= parameters.tolerance)
+            break;
+
+        if ((f < 0.) == (f0 < 0.))
+        {
+            t0 = t;
+            f0 = f;
+            if (side == -1)
+                f1 *= 0.5;
+            side = -1;
+        }
+        else
+        {
+            t1 = t;
+            f1 = f;
+            if (side == 1)
+                f0 *= 0.5;
+            side = 1;
+        }
+
+        t = (t0 * f1 - t1 * f0) / (f1 - f0);
+    }
+
+    return std::clamp(t, 0., 1.);
+}
+
+} // namespace detail
+
+/**
+ * @brief
+ * Cuts the mesh (V,T) along the zero level set of the signed distance function phi. phi is
+ * evaluated once per vertex in parallel, tetrahedra whose vertices have differing signs are cut,
+ * and the crossings of their edges are found once per mesh edge in parallel by root finding.
+ * Every sign pattern maps to a separating edge intersection mask, such that the cuts are performed
+ * by the existing subdivisions, using the given cutter's snapping, fracture, cut surface, quality
+ * measurement and journaling parameters. The cut shares one vertex per crossed edge between all
+ * tetrahedra incident to it, as cut_mesh does. Vertices where phi is zero lie on the level set
+ * already: only edges between vertices of strictly opposite signs are crossed, and tetrahedra
+ * crossed through such vertices are subdivided as if the level set had been snapped onto them,
+ * without creating vertices at them.
+ * @param cutter Cutter parameters
+ * @param V Vertex positions
+ * @param T Tetrahedra
+ * @param phi Callable taking an Eigen::Vector3d and returning a double, e.g. a lambda or a
+ * sampled_signed_distance_t, negative inside of the cut surface
+ * @param parameters Root finding parameters
+ * @return Number of tetrahedra that were cut
+ */
+template <class SignedDistance>
+int cut_mesh_with_level_set(
+    tetrahedron_mesh_cutter_t& cutter,
+    Eigen::MatrixXd& V,
+    Eigen::MatrixXi& T,
+    SignedDistance const& phi,
+    level_set_parameters_t const& parameters = {})
+{
+    cutter.quality = {};
+
+    Eigen::VectorXd const values  = evaluate_level_set(V, phi);
+    auto const is_negative_vertex = [&](int v) { return v < values.size() && values(v) < 0.; };
+    auto const is_positive_vertex = [&](int v) { return v < values.size() && values(v) > 0.; };
+    auto const is_crossed_edge    = [&](int vi, int vj) {
+        return (is_negative_vertex(vi) && is_positive_vertex(vj)) ||
+               (is_positive_vertex(vi) && is_negative_vertex(vj));
+    };
+
+    auto& candidates = cutter.candidate_tetrahedra;
+    candidates.clear();
+
+    std::unordered_map<std::uint64_t, int> edge_roots{};
+    std::vector<std::pair<int, int>> crossed_edges{};
+    for (int t = 0; t < T.rows(); ++t)
+    {
+        int negative_count = 0;
+        int positive_count = 0;
+        for (int j = 0; j < 4; ++j)
+        {
+            negative_count += is_negative_vertex(T(t, j)) ? 1 : 0;
+            positive_count += is_positive_vertex(T(t, j)) ? 1 : 0;
+        }
+
+        if (negative_count == 0 || positive_count == 0)
+            continue;
+
+        candidates.push_back(t);
+        for (auto const& edge : detail::tetrahedron_edges)
+        {
+            int const vi = T(t, edge[0]);
+            int const vj = T(t, edge[1]);
+            if (!is_crossed_edge(vi, vj))
+                continue;
+
+            auto const inserted = edge_roots.insert(
+                {detail::edge_key(vi, vj), static_cast<int>(crossed_edges.size())});
+            if (inserted.second)
+                crossed_edges.push_back({std::min(vi, vj), std::max(vi, vj)});
+        }
+    }
+
+    // crossings are parameterized from the edge's lower vertex index, such that every
+    // tetrahedron sharing the edge creates a vertex at the same position
+    std::vector<double> roots(crossed_edges.size());
+    igl::parallel_for(
+        static_cast<int>(crossed_edges.size()),
+        [&](int e) {
+            auto const [vi, vj] = crossed_edges[e];
+            roots[e]            = detail::find_edge_root(
+                phi,
+                V.row(vi).transpose(),
+                V.row(vj).transpose(),
+                values(vi),
+                values(vj),
+                parameters);
+        },
+        1000u);
+
+    int cut_count = 0;
+    cutter.begin_cut();
+    for (int const t : candidates)
+    {
+        std::byte surface_vertex_mask{0b00000000};
+        for (int j = 0; j < 4; ++j)
+            if (values(T(t, j)) == 0.)
+                surface_vertex_mask |= std::byte{static_cast<unsigned char>(1u << j)};
+
+        std::byte edge_intersection_mask{0b00000000};
+        std::array<intersection_point_t, 6u> edge_intersections{};
+        for (int e = 0; e < 6; ++e)
+        {
+            auto const& edge = detail::tetrahedron_edges[e];
+            int const vi     = T(t, edge[0]);
+            int const vj     = T(t, edge[1]);
+            if (!is_crossed_edge(vi, vj))
+                continue;
+
+            double const root = roots[edge_roots.at(detail::edge_key(vi, vj))];
+            double const s    = vi < vj ? root : 1. - root;
+
+            edge_intersection_mask |= std::byte{static_cast<unsigned char>(1u << e)};
+            edge_intersections[e].position = ((1. - s) * V.row(vi) + s * V.row(vj)).transpose();
+            edge_intersections[e].vertices = {edge[0], edge[1], -1};
+            edge_intersections[e].weights  = {1. - s, s, 0.};
+        }
+
+        // the side of a child is the side of its existing vertex farthest from the level set,
+        // since existing vertices snapped onto the level set may lie on either side
+        auto const is_negative = [&](int child) {
+            double value = 0.;
+            for (int j = 0; j < 4; ++j)
+            {
+                int const v = T(child, j);
+                if (v < values.size() && std::abs(values(v)) > std::abs(value))
+                    value = values(v);
+            }
+            return value < 0.;
+        };
+
+        if (subdivide_tetrahedron(
+                cutter,
+                V,
+                T,
+                t,
+                edge_intersection_mask,
+                edge_intersections,
+                {},
+                is_negative,
+                surface_vertex_mask))
+            ++cut_count;
+    }
+    cutter.end_cut();
+
+    return cut_count;
+}
+
+} // namespace geometry
+
+#endif // TET_CUT_LEVEL_SET_CUT_HPP
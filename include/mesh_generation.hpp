@@ -0,0 +1,165 @@
+#ifndef TET_CUT_MESH_GENERATION_HPP
+#define TET_CUT_MESH_GENERATION_HPP
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <igl/parallel_for.h>
+
+namespace geometry {
+
+namespace detail {
+
+/**
+ * @brief
+ * Kuhn (Freudenthal) subdivision of the unit cube into the 6 tetrahedra around its main diagonal
+ * from corner 0 to corner 7, where corner c has coordinates (c & 1, (c >> 1) & 1, (c >> 2) & 1).
+ * Every tetrahedron is positively oriented.
+ */
+std::array<std::array<int, 4u>, 6u> constexpr kuhn_tetrahedra{{
+    {0, 1, 3, 7},
+    {0, 3, 2, 7},
+    {0, 2, 6, 7},
+    {0, 6, 4, 7},
+    {0, 4, 5, 7},
+    {0, 5, 1, 7},
+}};
+
+// random number in [-1,1] determined by a seed and an index, independently of other indices
+double hashed_uniform(std::uint64_t seed, std::uint64_t index)
+{
+    std::uint64_t x = seed + (index + 1u) * 0x9e3779b97f4a7c15ull;
+    x               = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x               = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    x               = x ^ (x >> 31);
+    return static_cast<double>(x >> 11) * (2. / static_cast<double>(1ull << 53)) - 1.;
+}
+
+} // namespace detail
+
+/**
+ * @brief
+ * Generates the conforming tetrahedral mesh of the box [min,max] divided into nx*ny*nz cubes,
+ * each subdivided into 6 Kuhn tetrahedra. Vertex (i,j,k) is row i + (nx+1)*(j + (ny+1)*k) of V
+ * and the tetrahedra of cube (i,j,k) are rows 6*(i + nx*(j + ny*k)),... of T. Since all cubes
+ * share the same diagonal direction, the subdivision is conforming. V and T are filled in
+ * parallel.
+ * @param nx Number of cubes along x
+ * @param ny Number of cubes along y
+ * @param nz Number of cubes along z
+ * @param min Lower corner of the box
+ * @param max Upper corner of the box
+ * @param V Vertex positions
+ * @param T Tetrahedra
+ */
+void generate_cube_grid(
+    int nx,
+    int ny,
+    int nz,
+    Eigen::Vector3d const& min,
+    Eigen::Vector3d const& max,
+    Eigen::MatrixXd& V,
+    Eigen::MatrixXi& T)
+{
+    assert(nx > 0 && ny > 0 && nz > 0);
+
+    Eigen::Vector3d const spacing =
+        (max - min).cwiseQuotient(Eigen::Vector3d{double(nx), double(ny), double(nz)});
+
+    V.resize((nx + 1) * (ny + 1) * (nz + 1), 3);
+    T.resize(6 * nx * ny * nz, 4);
+
+    auto const vertex = [&](int i, int j, int k) {
+        return i + (nx + 1) * (j + (ny + 1) * k);
+    };
+
+    igl::parallel_for(
+        (ny + 1) * (nz + 1),
+        [&](int jk) {
+            int const j = jk % (ny + 1);
+            int const k = jk / (ny + 1);
+            for (int i = 0; i <= nx; ++i)
+            {
+                int const v = vertex(i, j, k);
+                V(v, 0)     = i == nx ? max(0) : min(0) + i * spacing(0);
+                V(v, 1)     = j == ny ? max(1) : min(1) + j * spacing(1);
+                V(v, 2)     = k == nz ? max(2) : min(2) + k * spacing(2);
+            }
+        },
+        64u);
+
+    igl::parallel_for(
+        ny * nz,
+        [&](int jk) {
+            int const j = jk % ny;
+            int const k = jk / ny;
+            for (int i = 0; i < nx; ++i)
+            {
+                std::array<int, 8u> corners{};
+                for (int c = 0; c < 8; ++c)
+                    corners[c] = vertex(i + (c & 1), j + ((c >> 1) & 1), k + ((c >> 2) & 1));
+
+                int const first = 6 * (i + nx * jk);
+                for (int t = 0; t < 6; ++t)
+                    for (int l = 0; l < 4; ++l)
+                        T(first + t, l) = corners[detail::kuhn_tetrahedra[t][l]];
+            }
+        },
+        64u);
+}
+
+/**
+ * @brief
+ * Number of cubes per axis of the cube grid whose tetrahedron count 6*n^3 is closest to the
+ * requested one
+ */
+int cube_grid_resolution(double tetrahedron_count)
+{
+    return std::max(1, static_cast<int>(std::lround(std::cbrt(tetrahedron_count / 6.))));
+}
+
+/**
+ * @brief
+ * Displaces every vertex of V that is not on the boundary of V's bounding box by a random offset
+ * of at most amplitude * spacing along each axis. The offsets only depend on the seed and the
+ * vertex index, such that the result does not depend on the number of threads. For Kuhn grids,
+ * tetrahedra stay positively oriented for amplitudes up to 0.15.
+ * @param V Vertex positions
+ * @param spacing Cube size along each axis
+ * @param amplitude Maximal displacement relative to the spacing
+ * @param seed Seed of the displacements
+ */
+void jitter_vertices(
+    Eigen::MatrixXd& V,
+    Eigen::Vector3d const& spacing,
+    double amplitude,
+    std::uint64_t seed = 0u)
+{
+    if (V.rows() == 0)
+        return;
+
+    Eigen::RowVector3d const min = V.colwise().minCoeff();
+    Eigen::RowVector3d const max = V.colwise().maxCoeff();
+
+    igl::parallel_for(
+        V.rows(),
+        [&](Eigen::Index v) {
+            for (int d = 0; d < 3; ++d)
+                if (V(v, d) == min(d) || V(v, d) == max(d))
+                    return;
+
+            for (int d = 0; d < 3; ++d)
+            {
+                auto const index = 3u * static_cast<std::uint64_t>(v) + static_cast<unsigned>(d);
+                V(v, d) += amplitude * spacing(d) * detail::hashed_uniform(seed, index);
+            }
+        },
+        1000u);
+}
+
+} // namespace geometry
+
+#endif // TET_CUT_MESH_GENERATION_HPP
@@ -0,0 +1,777 @@
+#ifndef TET_CUT_MESH_IO_HPP
+#define TET_CUT_MESH_IO_HPP
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <igl/parallel_for.h>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace geometry {
+
+namespace detail {
+
+std::size_t constexpr io_chunk_size = 1u << 20;
+
+bool read_file(std::string const& path, std::string& text)
+{
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    if (!file)
+        return false;
+
+    std::streamsize const size = file.tellg();
+    text.resize(static_cast<std::size_t>(size));
+    file.seekg(0);
+    return static_cast<bool>(file.read(text.data(), size));
+}
+
+/**
+ * @brief
+ * Offsets of the lines of text holding data, i.e. lines which are neither blank nor comments
+ * starting with '#'. The text is split in chunks which are indexed in parallel, where a line
+ * belongs to the chunk holding its first character, and the chunks' offsets are then stitched
+ * together in order.
+ */
+std::vector<std::size_t> index_lines(std::string_view text)
+{
+    std::size_t const chunk_count = (text.size() + io_chunk_size - 1u) / io_chunk_size;
+    std::vector<std::vector<std::size_t>> chunk_lines(chunk_count);
+
+    igl::parallel_for(
+        chunk_count,
+        [&](std::size_t c) {
+            std::size_t begin     = c * io_chunk_size;
+            std::size_t const end = std::min(text.size(), begin + io_chunk_size);
+            if (begin > 0u && text[begin - 1u] != '\n')
+            {
+                std::size_t const eol = text.find('\n', begin);
+                begin                 = eol == std::string_view::npos ? text.size() : eol + 1u;
+            }
+
+            for (std::size_t position = begin; position < end;)
+            {
+                std::size_t eol = text.find('\n', position);
+                eol             = eol == std::string_view::npos ? text.size() : eol;
+
+                std::size_t const first = text.find_first_not_of(" \t\r", position);
+                if (first < eol && text[first] != '#')
+                    chunk_lines[c].push_back(position);
+
+                position = eol + 1u;
+            }
+        },
+        1u);
+
+    std::vector<std::size_t> lines{};
+    for (auto const& offsets : chunk_lines)
+        lines.insert(lines.end(), offsets.begin(), offsets.end());
+
+    return lines;
+}
+
+/**
+ * @brief
+ * Parses whitespace separated numbers of a line with std::from_chars
+ */
+class line_parser_t
+{
+  public:
+    line_parser_t(std::string_view text, std::size_t offset)
+        : first_{text.data() + offset}, last_{text.data() + text.size()}
+    {
+        char const* const eol = static_cast<char const*>(
+            std::memchr(first_, '\n', static_cast<std::size_t>(last_ - first_)));
+        if (eol != nullptr)
+            last_ = eol;
+    }
+
+    template <class Number>
+    bool parse(Number& value)
+    {
+        while (first_ != last_ && (*first_ == ' ' || *first_ == '\t' || *first_ == '\r'))
+            ++first_;
+
+        auto const result = std::from_chars(first_, last_, value);
+        first_            = result.ptr;
+        return result.ec == std::errc{};
+    }
+
+    template <class Number>
+    bool skip()
+    {
+        Number value{};
+        return parse(value);
+    }
+
+  private:
+    char const* first_;
+    char const* last_;
+};
+
+/**
+ * @brief
+ * Formats count rows of text in parallel chunks and writes them to file in order
+ * @param format_row Callable appending row i to a std::string
+ */
+template <class FormatRow>
+bool write_rows(std::ofstream& file, std::size_t count, FormatRow const& format_row)
+{
+    std::size_t constexpr rows_per_chunk = 1u << 16;
+    std::size_t const chunk_count        = (count + rows_per_chunk - 1u) / rows_per_chunk;
+    std::vector<std::string> chunks(chunk_count);
+
+    igl::parallel_for(
+        chunk_count,
+        [&](std::size_t c) {
+            std::size_t const end = std::min(count, (c + 1u) * rows_per_chunk);
+            for (std::size_t i = c * rows_per_chunk; i < end; ++i)
+                format_row(i, chunks[c]);
+        },
+        1u);
+
+    for (auto const& chunk : chunks)
+        file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+
+    return static_cast<bool>(file);
+}
+
+template <class Number>
+void append_number(std::string& text, Number value, char separator)
+{
+    std::array<char, 32u> buffer{};
+    auto const result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    text.append(buffer.data(), result.ptr);
+    text.push_back(separator);
+}
+
+template <class T>
+void write_binary(std::ostream& file, T const& value)
+{
+    file.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+template <class T>
+bool read_binary(std::istream& file, T& value)
+{
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+/**
+ * @brief
+ * Number of nodes of the Gmsh element types up to second order, or 0 if unknown
+ */
+int msh_element_node_count(int element_type)
+{
+    switch (element_type)
+    {
+        case 1: return 2;
+        case 2: return 3;
+        case 3: return 4;
+        case 4: return 4;
+        case 5: return 8;
+        case 6: return 6;
+        case 7: return 5;
+        case 8: return 3;
+        case 9: return 6;
+        case 10: return 9;
+        case 11: return 10;
+        case 12: return 27;
+        case 13: return 18;
+        case 14: return 14;
+        case 15: return 1;
+        case 16: return 8;
+        case 17: return 20;
+        case 18: return 15;
+        case 19: return 13;
+        default: return 0;
+    }
+}
+
+int constexpr msh_tetrahedron_type = 4;
+
+bool read_msh_ascii(std::string_view text, Eigen::MatrixXd& V, Eigen::MatrixXi& T)
+{
+    auto const section = [&](std::string_view name) {
+        std::string const begin = "$" + std::string{name};
+        std::string const end   = "$End" + std::string{name};
+        std::size_t first       = text.find(begin);
+        std::size_t const last  = text.find(end);
+        if (first == std::string_view::npos || last == std::string_view::npos)
+            return std::string_view{};
+
+        first = text.find('\n', first) + 1u;
+        return text.substr(first, last - first);
+    };
+
+    std::string_view const nodes    = section("Nodes");
+    std::string_view const elements = section("Elements");
+    if (nodes.empty() || elements.empty())
+        return false;
+
+    std::atomic<bool> is_valid{true};
+
+    // nodes are listed by entity blocks, each holding the block's node tags followed by their
+    // coordinates
+    std::vector<std::size_t> const node_lines = index_lines(nodes);
+    if (node_lines.empty())
+        return false;
+
+    std::size_t block_count{}, node_count{}, min_tag{}, max_tag{};
+    line_parser_t header{nodes, node_lines[0]};
+    if (!header.parse(block_count) || !header.parse(node_count) || !header.parse(min_tag) ||
+        !header.parse(max_tag))
+        return false;
+
+    V.resize(static_cast<Eigen::Index>(node_count), 3);
+    std::vector<int> node_indices(max_tag - min_tag + 1u, -1);
+
+    std::size_t line = 1u;
+    std::size_t row  = 0u;
+    for (std::size_t b = 0; b < block_count; ++b)
+    {
+        std::size_t block_size{};
+        line_parser_t block_header{nodes, node_lines.at(line)};
+        if (!block_header.skip<int>() || !block_header.skip<int>() || !block_header.skip<int>() ||
+            !block_header.parse(block_size) || line + 1u + 2u * block_size > node_lines.size() ||
+            row + block_size > node_count)
+            return false;
+
+        std::size_t const first_tag_line        = line + 1u;
+        std::size_t const first_coordinate_line = first_tag_line + block_size;
+        igl::parallel_for(
+            block_size,
+            [&](std::size_t i) {
+                std::size_t tag{};
+                line_parser_t tag_parser{nodes, node_lines[first_tag_line + i]};
+                bool const is_tag_valid =
+                    tag_parser.parse(tag) && tag >= min_tag && tag <= max_tag;
+                if (is_tag_valid)
+                    node_indices[tag - min_tag] = static_cast<int>(row + i);
+
+                line_parser_t coordinate_parser{nodes, node_lines[first_coordinate_line + i]};
+                Eigen::Index const r = static_cast<Eigen::Index>(row + i);
+                if (!is_tag_valid || !coordinate_parser.parse(V(r, 0)) ||
+                    !coordinate_parser.parse(V(r, 1)) || !coordinate_parser.parse(V(r, 2)))
+                    is_valid = false;
+            },
+            1000u);
+
+        line += 1u + 2u * block_size;
+        row += block_size;
+    }
+
+    // elements are listed by entity blocks of a single element type, of which only tetrahedra
+    // are kept
+    std::vector<std::size_t> const element_lines = index_lines(elements);
+    if (element_lines.empty())
+        return false;
+
+    line_parser_t element_header{elements, element_lines[0]};
+    if (!element_header.parse(block_count))
+        return false;
+
+    struct block_t
+    {
+        std::size_t first_line;
+        std::size_t size;
+        std::size_t first_row;
+    };
+    std::vector<block_t> blocks{};
+
+    line = 1u;
+    row  = 0u;
+    for (std::size_t b = 0; b < block_count; ++b)
+    {
+        int element_type{};
+        std::size_t block_size{};
+        line_parser_t block_header{elements, element_lines.at(line)};
+        if (!block_header.skip<int>() || !block_header.skip<int>() ||
+            !block_header.parse(element_type) || !block_header.parse(block_size) ||
+            line + 1u + block_size > element_lines.size())
+            return false;
+
+        if (element_type == msh_tetrahedron_type)
+        {
+            blocks.push_back({line + 1u, block_size, row});
+            row += block_size;
+        }
+        line += 1u + block_size;
+    }
+
+    T.resize(static_cast<Eigen::Index>(row), 4);
+    for (auto const& block : blocks)
+    {
+        igl::parallel_for(
+            block.size,
+            [&](std::size_t i) {
+                line_parser_t parser{elements, element_lines[block.first_line + i]};
+                if (!parser.skip<std::size_t>())
+                    is_valid = false;
+
+                for (int j = 0; j < 4; ++j)
+                {
+                    std::size_t tag{};
+                    bool const is_tag_valid =
+                        parser.parse(tag) && tag >= min_tag && tag <= max_tag;
+                    int const v = is_tag_valid ? node_indices[tag - min_tag] : -1;
+                    if (v < 0)
+                        is_valid = false;
+
+                    T(static_cast<Eigen::Index>(block.first_row + i), j) = v;
+                }
+            },
+            1000u);
+    }
+
+    return is_valid;
+}
+
+bool skip_msh_section(std::istream& file)
+{
+    std::string line{};
+    while (std::getline(file, line))
+        if (line.rfind("$End", 0u) == 0u)
+            return true;
+
+    return false;
+}
+
+bool read_msh_binary(std::istream& file, Eigen::MatrixXd& V, Eigen::MatrixXi& T)
+{
+    int one{};
+    if (!read_binary(file, one) || one != 1)
+        return false;
+
+    std::size_t min_tag{}, max_tag{};
+    std::vector<int> node_indices{};
+    bool has_nodes = false;
+    std::vector<std::size_t> buffer{};
+
+    std::string line{};
+    while (std::getline(file, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        if (line == "$Nodes")
+        {
+            std::size_t block_count{}, node_count{};
+            if (!read_binary(file, block_count) || !read_binary(file, node_count) ||
+                !read_binary(file, min_tag) || !read_binary(file, max_tag))
+                return false;
+
+            V.resize(static_cast<Eigen::Index>(node_count), 3);
+            node_indices.assign(max_tag - min_tag + 1u, -1);
+
+            std::size_t row = 0u;
+            Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> block_V{};
+            for (std::size_t b = 0; b < block_count; ++b)
+            {
+                int entity_dimension{}, entity_tag{}, parametric{};
+                std::size_t block_size{};
+                if (!read_binary(file, entity_dimension) || !read_binary(file, entity_tag) ||
+                    !read_binary(file, parametric) || !read_binary(file, block_size) ||
+                    row + block_size > node_count)
+                    return false;
+
+                buffer.resize(block_size);
+                file.read(
+                    reinterpret_cast<char*>(buffer.data()),
+                    static_cast<std::streamsize>(block_size * sizeof(std::size_t)));
+
+                int const coordinate_count = 3 + (parametric != 0 ? entity_dimension : 0);
+                block_V.resize(static_cast<Eigen::Index>(block_size), coordinate_count);
+                file.read(
+                    reinterpret_cast<char*>(block_V.data()),
+                    static_cast<std::streamsize>(block_V.size() * sizeof(double)));
+                if (!file)
+                    return false;
+
+                for (std::size_t i = 0; i < block_size; ++i)
+                {
+                    if (buffer[i] < min_tag || buffer[i] > max_tag)
+                        return false;
+                    node_indices[buffer[i] - min_tag] = static_cast<int>(row + i);
+                }
+
+                V.middleRows(static_cast<Eigen::Index>(row), block_V.rows()) =
+                    block_V.leftCols(3);
+                row += block_size;
+            }
+            has_nodes = true;
+        }
+        else if (line == "$Elements")
+        {
+            if (!has_nodes)
+                return false;
+
+            std::size_t block_count{}, element_count{}, min_element_tag{}, max_element_tag{};
+            if (!read_binary(file, block_count) || !read_binary(file, element_count) ||
+                !read_binary(file, min_element_tag) || !read_binary(file, max_element_tag))
+                return false;
+
+            // tetrahedron blocks are streamed in chunks, such that the buffer stays small
+            std::size_t constexpr elements_per_chunk = 1u << 16;
+            T.resize(0, 4);
+            for (std::size_t b = 0; b < block_count; ++b)
+            {
+                int entity_dimension{}, entity_tag{}, element_type{};
+                std::size_t block_size{};
+                if (!read_binary(file, entity_dimension) || !read_binary(file, entity_tag) ||
+                    !read_binary(file, element_type) || !read_binary(file, block_size))
+                    return false;
+
+                int const node_count = msh_element_node_count(element_type);
+                if (node_count == 0)
+                    return false;
+
+                std::size_t const stride = 1u + static_cast<std::size_t>(node_count);
+                if (element_type != msh_tetrahedron_type)
+                {
+                    file.seekg(
+                        static_cast<std::streamoff>(block_size * stride * sizeof(std::size_t)),
+                        std::ios::cur);
+                    continue;
+                }
+
+                Eigen::Index row = T.rows();
+                T.conservativeResize(row + static_cast<Eigen::Index>(block_size), Eigen::NoChange);
+                for (std::size_t first = 0u; first < block_size; first += elements_per_chunk)
+                {
+                    std::size_t const count = std::min(elements_per_chunk, block_size - first);
+                    buffer.resize(count * stride);
+                    file.read(
+                        reinterpret_cast<char*>(buffer.data()),
+                        static_cast<std::streamsize>(buffer.size() * sizeof(std::size_t)));
+                    if (!file)
+                        return false;
+
+                    for (std::size_t i = 0; i < count; ++i, ++row)
+                    {
+                        for (int j = 0; j < 4; ++j)
+                        {
+                            std::size_t const tag = buffer[i * stride + 1u + j];
+                            if (tag < min_tag || tag > max_tag || node_indices[tag - min_tag] < 0)
+                                return false;
+                            T(row, j) = node_indices[tag - min_tag];
+                        }
+                    }
+                }
+            }
+        }
+        else if (!line.empty() && line[0] == '$' && line.rfind("$End", 0u) != 0u)
+        {
+            if (!skip_msh_section(file))
+                return false;
+        }
+    }
+
+    return has_nodes;
+}
+
+} // namespace detail
+
+/**
+ * @brief
+ * Reads a TetGen mesh from its .node and .ele files. Both files are parsed in parallel chunks.
+ * Attributes and boundary markers are ignored, and only the first four nodes of second order
+ * tetrahedra are kept.
+ * @return True on success
+ */
+bool read_tetgen(
+    std::string const& node_path,
+    std::string const& ele_path,
+    Eigen::MatrixXd& V,
+    Eigen::MatrixXi& T)
+{
+    std::string text{};
+    if (!detail::read_file(node_path, text))
+        return false;
+
+    std::vector<std::size_t> lines = detail::index_lines(text);
+    if (lines.empty())
+        return false;
+
+    int vertex_count{}, dimension{};
+    detail::line_parser_t node_header{text, lines[0]};
+    if (!node_header.parse(vertex_count) || !node_header.parse(dimension) || dimension != 3 ||
+        lines.size() < static_cast<std::size_t>(vertex_count) + 1u)
+        return false;
+
+    // nodes are numbered from 0 or 1, as given by the first node
+    int first_index{};
+    if (vertex_count > 0 && !detail::line_parser_t{text, lines[1]}.parse(first_index))
+        return false;
+
+    std::atomic<bool> is_valid{true};
+    V.resize(vertex_count, 3);
+    igl::parallel_for(
+        vertex_count,
+        [&](int i) {
+            detail::line_parser_t parser{text, lines[i + 1]};
+            if (!parser.skip<int>() || !parser.parse(V(i, 0)) || !parser.parse(V(i, 1)) ||
+                !parser.parse(V(i, 2)))
+                is_valid = false;
+        },
+        1000u);
+
+    if (!detail::read_file(ele_path, text))
+        return false;
+
+    lines = detail::index_lines(text);
+    if (lines.empty())
+        return false;
+
+    int tetrahedron_count{}, nodes_per_tetrahedron{};
+    detail::line_parser_t ele_header{text, lines[0]};
+    if (!ele_header.parse(tetrahedron_count) || !ele_header.parse(nodes_per_tetrahedron) ||
+        nodes_per_tetrahedron < 4 ||
+        lines.size() < static_cast<std::size_t>(tetrahedron_count) + 1u)
+        return false;
+
+    T.resize(tetrahedron_count, 4);
+    igl::parallel_for(
+        tetrahedron_count,
+        [&](int t) {
+            detail::line_parser_t parser{text, lines[t + 1]};
+            if (!parser.skip<int>())
+                is_valid = false;
+
+            for (int j = 0; j < 4; ++j)
+            {
+                int v{};
+                if (!parser.parse(v) || v - first_index < 0 || v - first_index >= vertex_count)
+                    is_valid = false;
+                T(t, j) = v - first_index;
+            }
+        },
+        1000u);
+
+    return is_valid;
+}
+
+/**
+ * @brief
+ * Writes a TetGen mesh to .node and .ele files, numbering nodes from 0. Rows are formatted in
+ * parallel chunks.
+ * @return True on success
+ */
+bool write_tetgen(
+    std::string const& node_path,
+    std::string const& ele_path,
+    Eigen::MatrixXd const& V,
+    Eigen::MatrixXi const& T)
+{
+    std::ofstream node_file{node_path, std::ios::binary};
+    node_file << V.rows() << " 3 0 0\n";
+    bool const is_node_written = detail::write_rows(
+        node_file,
+        static_cast<std::size_t>(V.rows()),
+        [&](std::size_t i, std::string& text) {
+            Eigen::Index const r = static_cast<Eigen::Index>(i);
+            detail::append_number(text, r, ' ');
+            detail::append_number(text, V(r, 0), ' ');
+            detail::append_number(text, V(r, 1), ' ');
+            detail::append_number(text, V(r, 2), '\n');
+        });
+
+    std::ofstream ele_file{ele_path, std::ios::binary};
+    ele_file << T.rows() << " 4 0\n";
+    bool const is_ele_written = detail::write_rows(
+        ele_file,
+        static_cast<std::size_t>(T.rows()),
+        [&](std::size_t i, std::string& text) {
+            Eigen::Index const r = static_cast<Eigen::Index>(i);
+            detail::append_number(text, r, ' ');
+            detail::append_number(text, T(r, 0), ' ');
+            detail::append_number(text, T(r, 1), ' ');
+            detail::append_number(text, T(r, 2), ' ');
+            detail::append_number(text, T(r, 3), '\n');
+        });
+
+    return is_node_written && is_ele_written;
+}
+
+/**
+ * @brief
+ * Reads the nodes and linear tetrahedra of a Gmsh 4.1 mesh, in ASCII or binary format. ASCII
+ * files are parsed in parallel chunks, whereas binary files are streamed block by block. Node
+ * tags are mapped to rows of V in file order, and elements other than tetrahedra are skipped.
+ * @return True on success
+ */
+bool read_msh(std::string const& path, Eigen::MatrixXd& V, Eigen::MatrixXi& T)
+{
+    std::ifstream file{path, std::ios::binary};
+    std::string line{};
+    if (!std::getline(file, line) || line.rfind("$MeshFormat", 0u) != 0u)
+        return false;
+
+    double version{};
+    int file_type{}, data_size{};
+    if (!(file >> version >> file_type >> data_size) || version < 4.1 || version >= 5. ||
+        data_size != static_cast<int>(sizeof(std::size_t)))
+        return false;
+
+    std::getline(file, line);
+    if (file_type == 1)
+        return detail::read_msh_binary(file, V, T);
+
+    file.close();
+    std::string text{};
+    return detail::read_file(path, text) && detail::read_msh_ascii(text, V, T);
+}
+
+/**
+ * @brief
+ * Writes a Gmsh 4.1 mesh holding a single volume entity with the nodes of V and the tetrahedra of
+ * T, in ASCII or binary format
+ * @return True on success
+ */
+bool write_msh(
+    std::string const& path,
+    Eigen::MatrixXd const& V,
+    Eigen::MatrixXi const& T,
+    bool is_binary = false)
+{
+    std::ofstream file{path, std::ios::binary};
+
+    std::size_t const vertex_count      = static_cast<std::size_t>(V.rows());
+    std::size_t const tetrahedron_count = static_cast<std::size_t>(T.rows());
+
+    Eigen::RowVector3d min = Eigen::RowVector3d::Zero();
+    Eigen::RowVector3d max = Eigen::RowVector3d::Zero();
+    if (V.rows() > 0)
+    {
+        min = V.colwise().minCoeff();
+        max = V.colwise().maxCoeff();
+    }
+
+    if (!is_binary)
+    {
+        file << "$MeshFormat\n4.1 0 " << sizeof(std::size_t) << "\n$EndMeshFormat\n";
+        file << "$Entities\n0 0 0 1\n1";
+        std::string bounds{};
+        for (int d = 0; d < 3; ++d)
+            detail::append_number(bounds, min(d), ' ');
+        for (int d = 0; d < 3; ++d)
+            detail::append_number(bounds, max(d), ' ');
+        file << " " << bounds << "0 0\n$EndEntities\n";
+
+        file << "$Nodes\n1 " << vertex_count << " 1 " << vertex_count << "\n3 1 0 " << vertex_count
+             << "\n";
+        detail::write_rows(file, vertex_count, [&](std::size_t i, std::string& text) {
+            detail::append_number(text, i + 1u, '\n');
+        });
+        detail::write_rows(file, vertex_count, [&](std::size_t i, std::string& text) {
+            Eigen::Index const r = static_cast<Eigen::Index>(i);
+            detail::append_number(text, V(r, 0), ' ');
+            detail::append_number(text, V(r, 1), ' ');
+            detail::append_number(text, V(r, 2), '\n');
+        });
+        file << "$EndNodes\n";
+
+        file << "$Elements\n1 " << tetrahedron_count << " 1 " << tetrahedron_count << "\n3 1 "
+             << detail::msh_tetrahedron_type << " " << tetrahedron_count << "\n";
+        detail::write_rows(file, tetrahedron_count, [&](std::size_t i, std::string& text) {
+            Eigen::Index const r = static_cast<Eigen::Index>(i);
+            detail::append_number(text, i + 1u, ' ');
+            detail::append_number(text, T(r, 0) + 1, ' ');
+            detail::append_number(text, T(r, 1) + 1, ' ');
+            detail::append_number(text, T(r, 2) + 1, ' ');
+            detail::append_number(text, T(r, 3) + 1, '\n');
+        });
+        file << "$EndElements\n";
+
+        return static_cast<bool>(file);
+    }
+
+    file << "$MeshFormat\n4.1 1 " << sizeof(std::size_t) << "\n";
+    detail::write_binary(file, 1);
+    file << "\n$EndMeshFormat\n";
+
+    file << "$Entities\n";
+    for (unsigned int const count : {0u, 0u, 0u, 1u})
+        detail::write_binary(file, std::size_t{count});
+    detail::write_binary(file, 1);
+    for (int d = 0; d < 3; ++d)
+        detail::write_binary(file, min(d));
+    for (int d = 0; d < 3; ++d)
+        detail::write_binary(file, max(d));
+    detail::write_binary(file, std::size_t{0u});
+    detail::write_binary(file, std::size_t{0u});
+    file << "\n$EndEntities\n";
+
+    // rows are streamed in chunks, such that the buffers stay small
+    std::size_t constexpr rows_per_chunk = 1u << 16;
+
+    file << "$Nodes\n";
+    for (std::size_t const value : {std::size_t{1u}, vertex_count, std::size_t{1u}, vertex_count})
+        detail::write_binary(file, value);
+    for (int const value : {3, 1, 0})
+        detail::write_binary(file, value);
+    detail::write_binary(file, vertex_count);
+
+    std::vector<std::size_t> tags{};
+    for (std::size_t first = 0u; first < vertex_count; first += rows_per_chunk)
+    {
+        std::size_t const count = std::min(rows_per_chunk, vertex_count - first);
+        tags.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+            tags[i] = first + i + 1u;
+        file.write(
+            reinterpret_cast<char const*>(tags.data()),
+            static_cast<std::streamsize>(count * sizeof(std::size_t)));
+    }
+
+    Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> block_V{};
+    for (std::size_t first = 0u; first < vertex_count; first += rows_per_chunk)
+    {
+        std::size_t const count = std::min(rows_per_chunk, vertex_count - first);
+        block_V = V.middleRows(static_cast<Eigen::Index>(first), static_cast<Eigen::Index>(count));
+        file.write(
+            reinterpret_cast<char const*>(block_V.data()),
+            static_cast<std::streamsize>(block_V.size() * sizeof(double)));
+    }
+    file << "\n$EndNodes\n";
+
+    file << "$Elements\n";
+    for (std::size_t const value :
+         {std::size_t{1u}, tetrahedron_count, std::size_t{1u}, tetrahedron_count})
+        detail::write_binary(file, value);
+    for (int const value : {3, 1, detail::msh_tetrahedron_type})
+        detail::write_binary(file, value);
+    detail::write_binary(file, tetrahedron_count);
+
+    std::vector<std::size_t> elements{};
+    for (std::size_t first = 0u; first < tetrahedron_count; first += rows_per_chunk)
+    {
+        std::size_t const count = std::min(rows_per_chunk, tetrahedron_count - first);
+        elements.resize(5u * count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Eigen::Index const r = static_cast<Eigen::Index>(first + i);
+            elements[5u * i]     = first + i + 1u;
+            for (int j = 0; j < 4; ++j)
+                elements[5u * i + 1u + j] = static_cast<std::size_t>(T(r, j)) + 1u;
+        }
+        file.write(
+            reinterpret_cast<char const*>(elements.data()),
+            static_cast<std::streamsize>(elements.size() * sizeof(std::size_t)));
+    }
+    file << "\n$EndElements\n";
+
+    return static_cast<bool>(file);
+}
+
+} // namespace geometry
+
+#endif // TET_CUT_MESH_IO_HPP
@@ -0,0 +1,163 @@
+#ifndef TET_CUT_MESH_PRIMITIVES_HPP
+#define TET_CUT_MESH_PRIMITIVES_HPP
+
+#include "mesh_reordering.hpp"
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <igl/parallel_for.h>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+namespace detail {
+
+std::uint64_t hash_combine(std::uint64_t seed, std::uint64_t value)
+{
+    // splitmix64 finalizer
+    std::uint64_t x = seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2));
+    x               = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x               = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+template <std::size_t N>
+std::uint64_t hash_indices(std::array<int, N> const& indices)
+{
+    std::uint64_t hash = 0u;
+    for (int const i : indices)
+        hash = hash_combine(hash, static_cast<std::uint64_t>(i));
+    return hash;
+}
+
+// hash of index arrays, e.g. sorted face keys, for unordered containers
+struct indices_hash_t
+{
+    template <std::size_t N>
+    std::size_t operator()(std::array<int, N> const& indices) const
+    {
+        return static_cast<std::size_t>(hash_indices(indices));
+    }
+};
+
+// key of the edge joining vertices vi and vj, independent of their order
+std::uint64_t edge_key(int vi, int vj)
+{
+    return static_cast<std::uint64_t>(std::min(vi, vj)) << 32 |
+           static_cast<std::uint64_t>(std::max(vi, vj));
+}
+
+/**
+ * @brief
+ * Sorts the vertices of a face into its key, independent of their order
+ * @return Parity of the sorting permutation, which distinguishes the face's two orientations
+ */
+int sort_face(std::array<int, 3u>& face)
+{
+    int parity = 0;
+    for (int i = 0; i < 2; ++i)
+    {
+        for (int j = 0; j < 2 - i; ++j)
+        {
+            if (face[j] > face[j + 1])
+            {
+                std::swap(face[j], face[j + 1]);
+                parity ^= 1;
+            }
+        }
+    }
+    return parity;
+}
+
+/**
+ * @brief
+ * Calls visit(i, j) for every pair of entries with equal keys, where entries are visited in order
+ * of their hashes and keys are compared exactly within runs of equal hashes
+ */
+template <class Key, class Visit>
+void visit_equal_keys(
+    std::vector<Key> const& keys,
+    std::vector<std::uint64_t> const& hashes,
+    Visit const& visit)
+{
+    std::vector<int> const order = parallel_argsort(hashes);
+    for (std::size_t begin = 0u; begin < order.size();)
+    {
+        std::size_t end = begin + 1u;
+        while (end < order.size() && hashes[order[end]] == hashes[order[begin]])
+            ++end;
+
+        for (std::size_t i = begin; i < end; ++i)
+            for (std::size_t j = i + 1u; j < end; ++j)
+                if (keys[order[i]] == keys[order[j]])
+                    visit(order[i], order[j]);
+
+        begin = end;
+    }
+}
+
+/**
+ * @brief
+ * Concatenates, in order, the items produced by produce(i, items) for i in [0,n) in parallel
+ * chunks
+ */
+template <class Item, class Produce>
+std::vector<Item> parallel_collect(int n, Produce const& produce)
+{
+    int constexpr chunk_size = 4096;
+    int const chunk_count    = (n + chunk_size - 1) / chunk_size;
+    std::vector<std::vector<Item>> chunks(static_cast<std::size_t>(chunk_count));
+    igl::parallel_for(
+        chunk_count,
+        [&](int c) {
+            int const end = std::min(n, (c + 1) * chunk_size);
+            for (int i = c * chunk_size; i < end; ++i)
+                produce(i, chunks[c]);
+        },
+        1);
+
+    std::vector<Item> items{};
+    for (auto const& chunk : chunks)
+        items.insert(items.end(), chunk.begin(), chunk.end());
+    return items;
+}
+
+/**
+ * @brief
+ * Barycentric coordinates of p with respect to the tetrahedron of the mesh (V,T) with the given
+ * vertices, as ratios of signed volumes
+ */
+Eigen::RowVector4d tetrahedron_barycentric_coordinates(
+    Eigen::RowVector3d const& p,
+    Eigen::MatrixXd const& V,
+    Eigen::RowVector4i const& tetrahedron)
+{
+    Eigen::Vector3d const q  = p.transpose();
+    Eigen::Vector3d const p1 = V.row(tetrahedron(0)).transpose();
+    Eigen::Vector3d const p2 = V.row(tetrahedron(1)).transpose();
+    Eigen::Vector3d const p3 = V.row(tetrahedron(2)).transpose();
+    Eigen::Vector3d const p4 = V.row(tetrahedron(3)).transpose();
+
+    double const volume = (p2 - p1).dot((p3 - p1).cross(p4 - p1));
+    if (volume == 0.)
+        return Eigen::RowVector4d::Constant(-std::numeric_limits<double>::infinity());
+
+    return Eigen::RowVector4d{
+               (p2 - q).dot((p3 - q).cross(p4 - q)),
+               (q - p1).dot((p3 - p1).cross(p4 - p1)),
+               (p2 - p1).dot((q - p1).cross(p4 - p1)),
+               (p2 - p1).dot((p3 - p1).cross(q - p1))} /
+           volume;
+}
+
+} // namespace detail
+
+} // namespace geometry
+
+#endif // TET_CUT_MESH_PRIMITIVES_HPP
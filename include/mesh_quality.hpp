@@ -0,0 +1,136 @@
+#ifndef TET_CUT_MESH_QUALITY_HPP
+#define TET_CUT_MESH_QUALITY_HPP
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Quality measures of a set of tetrahedra. Dihedral angles are in radians and the volume ratio
+ * is the smallest tetrahedron volume divided by a reference volume (i.e. the volume of the
+ * tetrahedron that was subdivided).
+ */
+struct tetrahedron_quality_t
+{
+    double min_dihedral_angle{std::numeric_limits<double>::max()};
+    double min_volume_ratio{std::numeric_limits<double>::max()};
+
+    // folds the measures of other tetrahedra into these, e.g. of a subdivision into a whole cut
+    void merge(tetrahedron_quality_t const& other)
+    {
+        min_dihedral_angle = std::min(min_dihedral_angle, other.min_dihedral_angle);
+        min_volume_ratio   = std::min(min_volume_ratio, other.min_volume_ratio);
+    }
+};
+
+namespace detail {
+
+using points_t = Eigen::Array<double, Eigen::Dynamic, 3>;
+
+Eigen::ArrayXd rowwise_dot(points_t const& a, points_t const& b)
+{
+    return (a * b).rowwise().sum();
+}
+
+points_t rowwise_cross(points_t const& a, points_t const& b)
+{
+    points_t c(a.rows(), 3);
+    c.col(0) = a.col(1) * b.col(2) - a.col(2) * b.col(1);
+    c.col(1) = a.col(2) * b.col(0) - a.col(0) * b.col(2);
+    c.col(2) = a.col(0) * b.col(1) - a.col(1) * b.col(0);
+    return c;
+}
+
+/**
+ * @brief
+ * Interior dihedral angles at edge pq of the tetrahedra pqrs, computed from the components of
+ * r-p and s-p orthogonal to the edge.
+ */
+Eigen::ArrayXd dihedral_angles_at_edge(
+    points_t const& p,
+    points_t const& q,
+    points_t const& r,
+    points_t const& s)
+{
+    points_t const e        = q - p;
+    Eigen::ArrayXd const ee = rowwise_dot(e, e);
+    points_t const pr       = r - p;
+    points_t const ps       = s - p;
+    points_t const u        = pr - e.colwise() * (rowwise_dot(pr, e) / ee);
+    points_t const w        = ps - e.colwise() * (rowwise_dot(ps, e) / ee);
+    Eigen::ArrayXd const cosines =
+        rowwise_dot(u, w) / (rowwise_dot(u, u) * rowwise_dot(w, w)).sqrt();
+    return cosines.max(-1.).min(1.).acos();
+}
+
+} // namespace detail
+
+/**
+ * @brief
+ * Computes quality measures of the given tetrahedra in a single vectorized pass over their
+ * gathered vertex positions
+ * @param V Vertex positions
+ * @param T Tetrahedra
+ * @param tetrahedra Rows of T to measure
+ * @param reference_volume Volume that tetrahedron volumes are measured against
+ * @return Minimum dihedral angle and minimum volume ratio over the given tetrahedra
+ */
+tetrahedron_quality_t compute_tetrahedron_quality(
+    Eigen::MatrixXd const& V,
+    Eigen::MatrixXi const& T,
+    std::vector<int> const& tetrahedra,
+    double reference_volume)
+{
+    tetrahedron_quality_t quality{};
+    if (tetrahedra.empty())
+        return quality;
+
+    int const n = static_cast<int>(tetrahedra.size());
+    detail::points_t p1(n, 3), p2(n, 3), p3(n, 3), p4(n, 3);
+    for (int i = 0; i < n; ++i)
+    {
+        int const t = tetrahedra[i];
+        p1.row(i)   = V.row(T(t, 0)).array();
+        p2.row(i)   = V.row(T(t, 1)).array();
+        p3.row(i)   = V.row(T(t, 2)).array();
+        p4.row(i)   = V.row(T(t, 3)).array();
+    }
+
+    Eigen::ArrayXd const volumes =
+        detail::rowwise_dot(p2 - p1, detail::rowwise_cross(p3 - p1, p4 - p1)) / 6.;
+
+    Eigen::ArrayXXd angles(n, 6);
+    angles.col(0) = detail::dihedral_angles_at_edge(p1, p2, p3, p4);
+    angles.col(1) = detail::dihedral_angles_at_edge(p2, p3, p1, p4);
+    angles.col(2) = detail::dihedral_angles_at_edge(p3, p1, p2, p4);
+    angles.col(3) = detail::dihedral_angles_at_edge(p1, p4, p2, p3);
+    angles.col(4) = detail::dihedral_angles_at_edge(p2, p4, p1, p3);
+    angles.col(5) = detail::dihedral_angles_at_edge(p3, p4, p1, p2);
+
+    quality.min_dihedral_angle = angles.minCoeff();
+    quality.min_volume_ratio   = volumes.minCoeff() / reference_volume;
+    return quality;
+}
+
+/**
+ * @brief
+ * Signed volume of tetrahedron t, positive when its vertices are in the orientation used by the
+ * subdivision cases
+ */
+double signed_volume(Eigen::MatrixXd const& V, Eigen::MatrixXi const& T, int t)
+{
+    Eigen::Vector3d const p1 = V.row(T(t, 0)).transpose();
+    Eigen::Vector3d const p2 = V.row(T(t, 1)).transpose();
+    Eigen::Vector3d const p3 = V.row(T(t, 2)).transpose();
+    Eigen::Vector3d const p4 = V.row(T(t, 3)).transpose();
+    return (p2 - p1).dot((p3 - p1).cross(p4 - p1)) / 6.;
+}
+
+} // namespace geometry
+
+#endif // TET_CUT_MESH_QUALITY_HPP
@@ -0,0 +1,220 @@
+#ifndef TET_CUT_MESH_REORDERING_HPP
+#define TET_CUT_MESH_REORDERING_HPP
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cstdint>
+#include <igl/parallel_for.h>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Old to new index maps of a reordered mesh, i.e. row i of the old V (resp. T) is row
+ * vertices(i) (resp. tetrahedra(i)) of the new V (resp. T)
+ */
+struct mesh_permutation_t
+{
+    Eigen::VectorXi vertices;
+    Eigen::VectorXi tetrahedra;
+};
+
+namespace detail {
+
+// spreads the lower 21 bits of x such that there are 2 zero bits between consecutive bits
+std::uint64_t expand_bits(std::uint64_t x)
+{
+    x &= 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffff;
+    x = (x | x << 16) & 0x1f0000ff0000ff;
+    x = (x | x << 8) & 0x100f00f00f00f00f;
+    x = (x | x << 4) & 0x10c30c30c30c30c3;
+    x = (x | x << 2) & 0x1249249249249249;
+    return x;
+}
+
+/**
+ * @brief
+ * Morton codes of points quantized to 21 bits per axis within their bounding box
+ */
+std::vector<std::uint64_t> morton_codes(Eigen::MatrixXd const& P)
+{
+    std::vector<std::uint64_t> codes(static_cast<std::size_t>(P.rows()));
+    if (P.rows() == 0)
+        return codes;
+
+    Eigen::RowVector3d const min    = P.colwise().minCoeff();
+    Eigen::RowVector3d const extent = P.colwise().maxCoeff() - min;
+    double const scale = static_cast<double>((1u << 21) - 1u) / std::max(extent.maxCoeff(), 1e-12);
+
+    igl::parallel_for(
+        P.rows(),
+        [&](Eigen::Index i) {
+            Eigen::RowVector3d const q = (P.row(i) - min) * scale;
+            codes[i] = expand_bits(static_cast<std::uint64_t>(q(0))) |
+                       expand_bits(static_cast<std::uint64_t>(q(1))) << 1 |
+                       expand_bits(static_cast<std::uint64_t>(q(2))) << 2;
+        },
+        1000u);
+
+    return codes;
+}
+
+/**
+ * @brief
+ * Sorts indices 0,...,n-1 by their keys by sorting chunks in parallel and merging pairs of
+ * sorted chunks in parallel rounds
+ * @return New to old index map
+ */
+std::vector<int> parallel_argsort(std::vector<std::uint64_t> const& keys)
+{
+    int const n = static_cast<int>(keys.size());
+    std::vector<std::pair<std::uint64_t, int>> entries(keys.size());
+    for (int i = 0; i < n; ++i)
+        entries[i] = {keys[i], i};
+
+    int constexpr chunk_size = 1 << 16;
+    int const chunk_count    = (n + chunk_size - 1) / chunk_size;
+    igl::parallel_for(chunk_count, [&](int c) {
+        auto const begin = entries.begin() + static_cast<std::ptrdiff_t>(c) * chunk_size;
+        auto const end   = entries.begin() + std::min(n, (c + 1) * chunk_size);
+        std::sort(begin, end);
+    });
+
+    for (int width = chunk_size; width < n; width *= 2)
+    {
+        int const merge_count = (n + 2 * width - 1) / (2 * width);
+        igl::parallel_for(merge_count, [&](int m) {
+            int const first = m * 2 * width;
+            int const mid   = std::min(n, first + width);
+            int const last  = std::min(n, first + 2 * width);
+            std::inplace_merge(
+                entries.begin() + first,
+                entries.begin() + mid,
+                entries.begin() + last);
+        });
+    }
+
+    std::vector<int> order(keys.size());
+    for (int i = 0; i < n; ++i)
+        order[i] = entries[i].second;
+
+    return order;
+}
+
+} // namespace detail
+
+/**
+ * @brief
+ * Reorders rows of V along a Morton curve through the vertex positions, and rows of T along a
+ * Morton curve through the tetrahedron barycenters, such that spatially close vertices and
+ * tetrahedra are close in memory. Tetrahedron vertex orderings are preserved.
+ * @param V Vertex positions
+ * @param T Tetrahedra
+ * @return Old to new permutations, which remap external per-vertex and per-tetrahedron arrays
+ * with apply_permutation
+ */
+mesh_permutation_t reorder_mesh(Eigen::MatrixXd& V, Eigen::MatrixXi& T)
+{
+    mesh_permutation_t permutation{};
+
+    std::vector<int> const vertex_order = detail::parallel_argsort(detail::morton_codes(V));
+    permutation.vertices.resize(V.rows());
+    Eigen::MatrixXd RV(V.rows(), V.cols());
+    igl::parallel_for(
+        V.rows(),
+        [&](Eigen::Index i) {
+            permutation.vertices(vertex_order[i]) = static_cast<int>(i);
+            RV.row(i)                             = V.row(vertex_order[i]);
+        },
+        1000u);
+
+    Eigen::MatrixXd BC(T.rows(), 3);
+    igl::parallel_for(
+        T.rows(),
+        [&](Eigen::Index t) {
+            BC.row(t) = 0.25 * (V.row(T(t, 0)) + V.row(T(t, 1)) + V.row(T(t, 2)) + V.row(T(t, 3)));
+        },
+        1000u);
+
+    std::vector<int> const tetrahedron_order = detail::parallel_argsort(detail::morton_codes(BC));
+    permutation.tetrahedra.resize(T.rows());
+    Eigen::MatrixXi RT(T.rows(), T.cols());
+    igl::parallel_for(
+        T.rows(),
+        [&](Eigen::Index t) {
+            int const old_t               = tetrahedron_order[t];
+            permutation.tetrahedra(old_t) = static_cast<int>(t);
+            for (int j = 0; j < T.cols(); ++j)
+                RT(t, j) = permutation.vertices(T(old_t, j));
+        },
+        1000u);
+
+    V = std::move(RV);
+    T = std::move(RT);
+    return permutation;
+}
+
+/**
+ * @brief
+ * Moves row i of A to row permutation(i)
+ * @param permutation Old to new index map
+ * @param A Per-vertex or per-tetrahedron array
+ */
+template <class DerivedA>
+void apply_permutation(Eigen::VectorXi const& permutation, Eigen::PlainObjectBase<DerivedA>& A)
+{
+    typename Eigen::PlainObjectBase<DerivedA>::PlainObject RA(A.rows(), A.cols());
+    igl::parallel_for(
+        A.rows(),
+        [&](Eigen::Index i) { RA.row(permutation(i)) = A.row(i); },
+        1000u);
+    A.derived() = std::move(RA);
+}
+
+/**
+ * @brief
+ * Triggers reordering of a mesh once the rows appended by cuts since the last reordering exceed
+ * a fraction of the mesh
+ */
+struct mesh_reordering_trigger_t
+{
+    double appended_fraction_threshold{0.25};
+    // number of tetrahedra at the last reordering, 0 until the first call records the mesh's
+    Eigen::Index tetrahedron_count{0};
+
+    bool should_reorder(Eigen::MatrixXi const& T) const
+    {
+        return tetrahedron_count > 0 &&
+               static_cast<double>(T.rows() - tetrahedron_count) >
+                   appended_fraction_threshold * static_cast<double>(tetrahedron_count);
+    }
+
+    /**
+     * @brief
+     * Reorders (V,T) if should_reorder(T). The first call on a default constructed trigger only
+     * records the number of tetrahedra.
+     * @return True if the mesh was reordered, in which case permutation is filled
+     */
+    bool reorder_if_needed(Eigen::MatrixXd& V, Eigen::MatrixXi& T, mesh_permutation_t& permutation)
+    {
+        if (tetrahedron_count == 0)
+        {
+            tetrahedron_count = T.rows();
+            return false;
+        }
+
+        if (!should_reorder(T))
+            return false;
+
+        permutation       = reorder_mesh(V, T);
+        tetrahedron_count = T.rows();
+        return true;
+    }
+};
+
+} // namespace geometry
+
+#endif // TET_CUT_MESH_REORDERING_HPP
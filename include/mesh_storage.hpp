@@ -0,0 +1,620 @@
+#ifndef TET_CUT_MESH_STORAGE_HPP
+#define TET_CUT_MESH_STORAGE_HPP
+
+#include "cut_tetrahedron.hpp"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Access to the vertices and tetrahedra of a mesh stored in a user-defined layout. A
+ * specialization for a mesh type Mesh provides
+ *
+ *   static int vertex_count(Mesh const&);
+ *   static int tetrahedron_count(Mesh const&);
+ *   static Eigen::RowVector3d vertex(Mesh const&, int v);
+ *   static void set_vertex(Mesh&, int v, Eigen::RowVector3d const& position);
+ *   static Eigen::RowVector4i tetrahedron(Mesh const&, int t);
+ *   static void set_tetrahedron(Mesh&, int t, Eigen::RowVector4i const& tetrahedron);
+ *   static bool append(Mesh&, int vertex_count, int tetrahedron_count);
+ *
+ * where append grows the mesh by the given number of rows, leaving their contents unspecified,
+ * or returns false and leaves the mesh unchanged if the storage cannot hold them.
+ */
+template <class Mesh>
+struct mesh_traits;
+
+/**
+ * @brief
+ * Mesh stored in Eigen matrices (V,T), as used by the rest of the library
+ */
+struct eigen_mesh_t
+{
+    Eigen::MatrixXd& V;
+    Eigen::MatrixXi& T;
+};
+
+template <>
+struct mesh_traits<eigen_mesh_t>
+{
+    static int vertex_count(eigen_mesh_t const& mesh) { return static_cast<int>(mesh.V.rows()); }
+    static int tetrahedron_count(eigen_mesh_t const& mesh)
+    {
+        return static_cast<int>(mesh.T.rows());
+    }
+
+    static Eigen::RowVector3d vertex(eigen_mesh_t const& mesh, int v) { return mesh.V.row(v); }
+    static void set_vertex(eigen_mesh_t& mesh, int v, Eigen::RowVector3d const& position)
+    {
+        mesh.V.row(v) = position;
+    }
+
+    static Eigen::RowVector4i tetrahedron(eigen_mesh_t const& mesh, int t) { return mesh.T.row(t); }
+    static void set_tetrahedron(eigen_mesh_t& mesh, int t, Eigen::RowVector4i const& tetrahedron)
+    {
+        mesh.T.row(t) = tetrahedron;
+    }
+
+    static bool append(eigen_mesh_t& mesh, int vertex_count, int tetrahedron_count)
+    {
+        mesh.V.conservativeResize(mesh.V.rows() + vertex_count, Eigen::NoChange);
+        mesh.T.conservativeResize(mesh.T.rows() + tetrahedron_count, Eigen::NoChange);
+        return true;
+    }
+};
+
+/**
+ * @brief
+ * Mesh stored in external memory viewed through Eigen::Map, e.g. row-major arrays of positions
+ * and vertex indices, or positions stored per component with a column-major map whose outer
+ * stride is the vertex capacity. The maps span the whole allocation, of which the first
+ * vertex_count and tetrahedron_count rows are in use, and appends fail once it is full.
+ */
+template <class VertexMap, class TetrahedronMap>
+struct mapped_mesh_t
+{
+    VertexMap V;
+    TetrahedronMap T;
+    int vertex_count;
+    int tetrahedron_count;
+};
+
+template <class VertexMap, class TetrahedronMap>
+struct mesh_traits<mapped_mesh_t<VertexMap, TetrahedronMap>>
+{
+    using mesh_type = mapped_mesh_t<VertexMap, TetrahedronMap>;
+
+    static int vertex_count(mesh_type const& mesh) { return mesh.vertex_count; }
+    static int tetrahedron_count(mesh_type const& mesh) { return mesh.tetrahedron_count; }
+
+    static Eigen::RowVector3d vertex(mesh_type const& mesh, int v) { return mesh.V.row(v); }
+    static void set_vertex(mesh_type& mesh, int v, Eigen::RowVector3d const& position)
+    {
+        mesh.V.row(v) = position;
+    }
+
+    static Eigen::RowVector4i tetrahedron(mesh_type const& mesh, int t) { return mesh.T.row(t); }
+    static void set_tetrahedron(mesh_type& mesh, int t, Eigen::RowVector4i const& tetrahedron)
+    {
+        mesh.T.row(t) = tetrahedron;
+    }
+
+    static bool append(mesh_type& mesh, int vertex_count, int tetrahedron_count)
+    {
+        if (mesh.vertex_count + vertex_count > mesh.V.rows() ||
+            mesh.tetrahedron_count + tetrahedron_count > mesh.T.rows())
+            return false;
+
+        mesh.vertex_count += vertex_count;
+        mesh.tetrahedron_count += tetrahedron_count;
+        return true;
+    }
+};
+
+/**
+ * @brief
+ * Mesh stored in STL vectors, with positions either interleaved (one array per vertex) or per
+ * component (one vector per coordinate)
+ */
+struct vector_mesh_t
+{
+    std::vector<std::array<double, 3u>>& V;
+    std::vector<std::array<int, 4u>>& T;
+};
+
+struct component_vector_mesh_t
+{
+    std::vector<double>& x;
+    std::vector<double>& y;
+    std::vector<double>& z;
+    std::vector<std::array<int, 4u>>& T;
+};
+
+namespace detail {
+
+// traits of the tetrahedra shared by the STL vector meshes
+template <class Mesh>
+struct vector_tetrahedra_traits
+{
+    static int tetrahedron_count(Mesh const& mesh) { return static_cast<int>(mesh.T.size()); }
+
+    static Eigen::RowVector4i tetrahedron(Mesh const& mesh, int t)
+    {
+        auto const& tetrahedron = mesh.T[static_cast<std::size_t>(t)];
+        return {tetrahedron[0], tetrahedron[1], tetrahedron[2], tetrahedron[3]};
+    }
+
+    static void set_tetrahedron(Mesh& mesh, int t, Eigen::RowVector4i const& tetrahedron)
+    {
+        mesh.T[static_cast<std::size_t>(t)] =
+            {tetrahedron(0), tetrahedron(1), tetrahedron(2), tetrahedron(3)};
+    }
+};
+
+} // namespace detail
+
+template <>
+struct mesh_traits<vector_mesh_t> : detail::vector_tetrahedra_traits<vector_mesh_t>
+{
+    static int vertex_count(vector_mesh_t const& mesh) { return static_cast<int>(mesh.V.size()); }
+
+    static Eigen::RowVector3d vertex(vector_mesh_t const& mesh, int v)
+    {
+        auto const& position = mesh.V[static_cast<std::size_t>(v)];
+        return {position[0], position[1], position[2]};
+    }
+
+    static void set_vertex(vector_mesh_t& mesh, int v, Eigen::RowVector3d const& position)
+    {
+        mesh.V[static_cast<std::size_t>(v)] = {position(0), position(1), position(2)};
+    }
+
+    static bool append(vector_mesh_t& mesh, int vertex_count, int tetrahedron_count)
+    {
+        mesh.V.resize(mesh.V.size() + static_cast<std::size_t>(vertex_count));
+        mesh.T.resize(mesh.T.size() + static_cast<std::size_t>(tetrahedron_count));
+        return true;
+    }
+};
+
+template <>
+struct mesh_traits<component_vector_mesh_t>
+    : detail::vector_tetrahedra_traits<component_vector_mesh_t>
+{
+    static int vertex_count(component_vector_mesh_t const& mesh)
+    {
+        return static_cast<int>(mesh.x.size());
+    }
+
+    static Eigen::RowVector3d vertex(component_vector_mesh_t const& mesh, int v)
+    {
+        auto const i = static_cast<std::size_t>(v);
+        return {mesh.x[i], mesh.y[i], mesh.z[i]};
+    }
+
+    static void
+    set_vertex(component_vector_mesh_t& mesh, int v, Eigen::RowVector3d const& position)
+    {
+        auto const i = static_cast<std::size_t>(v);
+        mesh.x[i]    = position(0);
+        mesh.y[i]    = position(1);
+        mesh.z[i]    = position(2);
+    }
+
+    static bool append(component_vector_mesh_t& mesh, int vertex_count, int tetrahedron_count)
+    {
+        std::size_t const size = mesh.x.size() + static_cast<std::size_t>(vertex_count);
+        mesh.x.resize(size);
+        mesh.y.resize(size);
+        mesh.z.resize(size);
+        mesh.T.resize(mesh.T.size() + static_cast<std::size_t>(tetrahedron_count));
+        return true;
+    }
+};
+
+namespace detail {
+
+/**
+ * @brief
+ * Subdivision of one tetrahedron performed on a local copy of its four vertices, whose local
+ * indices 0,...,3 stand for the tetrahedron's vertices and whose row 0 stands for the subdivided
+ * row, along with the sources of its vertices, in order, and the cut surface triangles it
+ * recorded. Once committed to a mesh, these refer to rows of the mesh. Local vertices 4,... are
+ * appended to the mesh, except those sharing a vertex of the mesh created by a neighbour.
+ */
+struct staged_subdivision_t
+{
+    Eigen::RowVector4i tetrahedron{};
+    Eigen::MatrixXd V{};
+    Eigen::MatrixXi T{};
+    std::vector<vertex_source_t> vertex_sources{};
+    std::vector<cut_surface_triangle_t> cut_surface{};
+
+    // rows of the mesh shared by local vertices 4,..., or -1 for vertices to append, empty if
+    // every vertex is appended
+    std::vector<int> shared_vertices{};
+
+    bool is_shared(std::size_t i) const
+    {
+        return !shared_vertices.empty() && shared_vertices[i] >= 0;
+    }
+
+    int appended_vertex_count() const
+    {
+        return static_cast<int>(V.rows()) - 4 -
+               static_cast<int>(std::count_if(
+                   shared_vertices.begin(),
+                   shared_vertices.end(),
+                   [](int v) { return v >= 0; }));
+    }
+    int appended_tetrahedron_count() const { return static_cast<int>(T.rows()) - 1; }
+};
+
+/**
+ * @brief
+ * Stages the subdivision of a tetrahedron with vertices tetrahedron and positions positions.
+ * subdivide(cutter, V, T) runs on the local copy with the cutter's vertex sources, which are
+ * always recorded, and cut surface outputs redirected into staged, and the cutter's delta
+ * detached.
+ * @return Result of subdivide, false if the cutter cannot defer positions
+ */
+template <class Subdivide>
+bool stage_subdivision(
+    tetrahedron_mesh_cutter_t& cutter,
+    Eigen::RowVector4i const& tetrahedron,
+    std::array<Eigen::RowVector3d, 4u> const& positions,
+    staged_subdivision_t& staged,
+    Subdivide const& subdivide)
+{
+    assert(cutter.journal == nullptr && cutter.rest_positions == nullptr);
+    if (!cutter.can_defer_positions())
+        return false;
+
+    staged.tetrahedron = tetrahedron;
+    staged.V.resize(4, 3);
+    staged.T.resize(1, 4);
+    for (int i = 0; i < 4; ++i)
+        staged.V.row(i) = positions[i];
+    staged.T.row(0) << 0, 1, 2, 3;
+    staged.vertex_sources.clear();
+    staged.cut_surface.clear();
+    staged.shared_vertices.clear();
+
+    auto* const vertex_sources = cutter.vertex_sources;
+    auto* const cut_surface    = cutter.cut_surface;
+    auto* const delta          = cutter.delta;
+    cutter.vertex_sources      = &staged.vertex_sources;
+    cutter.cut_surface         = cut_surface != nullptr ? &staged.cut_surface : nullptr;
+    cutter.delta               = nullptr;
+    cutter.local_vertices      = &staged.tetrahedron;
+
+    bool const result = subdivide(cutter, staged.V, staged.T);
+
+    cutter.vertex_sources = vertex_sources;
+    cutter.cut_surface    = cut_surface;
+    cutter.delta          = delta;
+    cutter.local_vertices = nullptr;
+    return result;
+}
+
+/**
+ * @brief
+ * Index of the vertex source of a staged subdivision that its i-th vertex source is a fracture
+ * copy of, or i if it copies none of them
+ */
+std::size_t copied_vertex_source(staged_subdivision_t const& staged, std::size_t i)
+{
+    int const copied_vertex = staged.vertex_sources[i].copied_vertex;
+    return copied_vertex >= 4 ? static_cast<std::size_t>(copied_vertex - 4) : i;
+}
+
+/**
+ * @brief
+ * Finds the vertices of the mesh that the cutter's subdivisions since begin_cut created on the
+ * edges and faces crossed by a staged subdivision, or copied, and that its appended vertices
+ * share instead
+ */
+void find_shared_vertices(tetrahedron_mesh_cutter_t const& cutter, staged_subdivision_t& staged)
+{
+    std::size_t const vertex_count = static_cast<std::size_t>(staged.V.rows()) - 4u;
+    assert(staged.vertex_sources.size() == vertex_count);
+    staged.shared_vertices.assign(vertex_count, -1);
+    for (std::size_t i = 0u; i < vertex_count; ++i)
+    {
+        std::size_t const original = copied_vertex_source(staged, i);
+        if (original < i)
+        {
+            int const shared = staged.shared_vertices[original];
+            staged.shared_vertices[i] = shared >= 0 ? cutter.shared_copy(shared) : -1;
+            continue;
+        }
+
+        vertex_source_t source = staged.vertex_sources[i];
+        for (int& parent : source.vertices)
+            if (parent >= 0)
+                parent = staged.tetrahedron(parent);
+        staged.shared_vertices[i] = cutter.shared_vertex(source);
+    }
+}
+
+/**
+ * @brief
+ * Shares the vertices that a staged subdivision appends to the mesh from row first_vertex on, as
+ * commit_subdivision places them, with the cutter's later subdivisions until end_cut
+ */
+void share_staged_vertices(
+    tetrahedron_mesh_cutter_t& cutter,
+    staged_subdivision_t const& staged,
+    int first_vertex)
+{
+    std::vector<int> vertex_rows(staged.vertex_sources.size());
+    int next_vertex = first_vertex;
+    for (std::size_t i = 0u; i < vertex_rows.size(); ++i)
+    {
+        if (staged.is_shared(i))
+        {
+            vertex_rows[i] = staged.shared_vertices[i];
+            continue;
+        }
+
+        vertex_rows[i]             = next_vertex++;
+        std::size_t const original = copied_vertex_source(staged, i);
+        if (original < i)
+        {
+            cutter.share_copy(vertex_rows[original], vertex_rows[i]);
+            continue;
+        }
+
+        vertex_source_t source = staged.vertex_sources[i];
+        source.vertex          = vertex_rows[i];
+        for (int& parent : source.vertices)
+            if (parent >= 0)
+                parent = staged.tetrahedron(parent);
+        cutter.share_vertex(source);
+    }
+}
+
+/**
+ * @brief
+ * Writes a staged subdivision of the mesh's row tetrahedron into rows of the mesh, with appended
+ * vertices and tetrahedra starting at first_vertex and first_tetrahedron, which the caller has
+ * already appended. Shared vertices are not written. The staged vertex sources and cut surface
+ * triangles are translated to rows of the mesh in place.
+ * @param write_positions False if the cutter deferred positions, which are then set to zero
+ */
+template <class Mesh>
+void commit_subdivision(
+    Mesh& mesh,
+    int tetrahedron,
+    staged_subdivision_t& staged,
+    int first_vertex,
+    int first_tetrahedron,
+    bool write_positions)
+{
+    using traits = mesh_traits<Mesh>;
+
+    std::vector<int> vertex_rows(static_cast<std::size_t>(staged.V.rows()) - 4u);
+    int next_vertex = first_vertex;
+    for (std::size_t i = 0u; i < vertex_rows.size(); ++i)
+        vertex_rows[i] = staged.is_shared(i) ? staged.shared_vertices[i] : next_vertex++;
+
+    auto const to_mesh_vertex = [&](int v) {
+        return v < 4 ? staged.tetrahedron(v) : vertex_rows[static_cast<std::size_t>(v - 4)];
+    };
+    auto const to_mesh_tetrahedron = [&](int t) {
+        return t == 0 ? tetrahedron : first_tetrahedron + t - 1;
+    };
+
+    for (int v = 4; v < staged.V.rows(); ++v)
+    {
+        if (staged.is_shared(static_cast<std::size_t>(v - 4)))
+            continue;
+
+        traits::set_vertex(
+            mesh,
+            to_mesh_vertex(v),
+            write_positions ? Eigen::RowVector3d{staged.V.row(v)} : Eigen::RowVector3d::Zero());
+    }
+
+    for (int t = 0; t < staged.T.rows(); ++t)
+    {
+        traits::set_tetrahedron(
+            mesh,
+            to_mesh_tetrahedron(t),
+            staged.T.row(t).unaryExpr(to_mesh_vertex));
+    }
+
+    for (auto& source : staged.vertex_sources)
+    {
+        source.vertex = to_mesh_vertex(source.vertex);
+        if (source.is_copy())
+            source.copied_vertex = to_mesh_vertex(source.copied_vertex);
+        for (int& parent : source.vertices)
+            if (parent >= 0)
+                parent = to_mesh_vertex(parent);
+    }
+
+    for (auto& triangle : staged.cut_surface)
+    {
+        triangle.vertices               = triangle.vertices.unaryExpr(to_mesh_vertex);
+        triangle.tetrahedron            = to_mesh_tetrahedron(triangle.tetrahedron);
+        triangle.subdivided_tetrahedron = tetrahedron;
+    }
+}
+
+/**
+ * @brief
+ * Appends the sources of the vertices that a committed subdivision of the mesh's row tetrahedron
+ * appended, and its cut surface triangles, to the cutter's outputs, and records it in the
+ * cutter's delta
+ */
+void record_subdivision(
+    tetrahedron_mesh_cutter_t& cutter,
+    int tetrahedron,
+    staged_subdivision_t const& staged,
+    int first_vertex,
+    int first_tetrahedron)
+{
+    if (cutter.vertex_sources != nullptr)
+    {
+        for (std::size_t i = 0u; i < staged.vertex_sources.size(); ++i)
+            if (!staged.is_shared(i))
+                cutter.vertex_sources->push_back(staged.vertex_sources[i]);
+    }
+
+    if (cutter.cut_surface != nullptr)
+    {
+        cutter.cut_surface->insert(
+            cutter.cut_surface->end(),
+            staged.cut_surface.begin(),
+            staged.cut_surface.end());
+    }
+
+    if (cutter.delta != nullptr && staged.appended_tetrahedron_count() > 0)
+    {
+        cutter.delta->record(
+            {tetrahedron,
+             staged.tetrahedron,
+             first_tetrahedron,
+             staged.appended_tetrahedron_count(),
+             first_vertex,
+             staged.appended_vertex_count()});
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief
+ * Cuts a tetrahedron of a mesh accessed through mesh_traits with the triangle formed by
+ * start_line and end_line. The tetrahedron is subdivided in a local copy of its four vertices,
+ * and only the resulting rows are written back, such that the mesh is never copied as a whole.
+ * Vertex sources, cut surface triangles and the delta are recorded with rows of the mesh. Between
+ * the cutter's begin_cut and end_cut, vertices are shared with the neighbours cut before.
+ * Journaling and rest positions require Eigen matrices and are not supported.
+ * @return True if the tetrahedron's intersection is supported and the storage could hold the
+ * new rows, in which case the mesh is unchanged otherwise
+ */
+template <class Mesh>
+bool cut_tetrahedron(
+    tetrahedron_mesh_cutter_t& cutter,
+    Mesh& mesh,
+    int tetrahedron,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line)
+{
+    using traits = mesh_traits<Mesh>;
+
+    Eigen::RowVector4i const replaced_tetrahedron = traits::tetrahedron(mesh, tetrahedron);
+    std::array<Eigen::RowVector3d, 4u> positions{};
+    for (int i = 0; i < 4; ++i)
+        positions[i] = traits::vertex(mesh, replaced_tetrahedron(i));
+
+    detail::staged_subdivision_t staged{};
+    bool const result = detail::stage_subdivision(
+        cutter,
+        replaced_tetrahedron,
+        positions,
+        staged,
+        [&](tetrahedron_mesh_cutter_t& local_cutter, Eigen::MatrixXd& V, Eigen::MatrixXi& T) {
+            return cut_tetrahedron(local_cutter, V, T, 0, start_line, end_line);
+        });
+
+    if (result && cutter.is_sharing_vertices())
+        detail::find_shared_vertices(cutter, staged);
+
+    int const appended_vertex_count      = staged.appended_vertex_count();
+    int const appended_tetrahedron_count = staged.appended_tetrahedron_count();
+    if (!result || (appended_vertex_count == 0 && appended_tetrahedron_count == 0))
+        return result;
+
+    int const first_vertex      = traits::vertex_count(mesh);
+    int const first_tetrahedron = traits::tetrahedron_count(mesh);
+    if (!traits::append(mesh, appended_vertex_count, appended_tetrahedron_count))
+        return false;
+
+    if (cutter.is_sharing_vertices())
+        detail::share_staged_vertices(cutter, staged, first_vertex);
+
+    detail::commit_subdivision(
+        mesh,
+        tetrahedron,
+        staged,
+        first_vertex,
+        first_tetrahedron,
+        !cutter.defer_positions);
+    detail::record_subdivision(cutter, tetrahedron, staged, first_vertex, first_tetrahedron);
+
+    return result;
+}
+
+/**
+ * @brief
+ * Cuts every tetrahedron of a mesh accessed through mesh_traits that is intersected by the
+ * triangle formed by start_line and end_line, operating directly on the mesh's storage. Tetrahedra
+ * whose bounding box does not overlap the triangle's are culled before the intersection tests.
+ * If the cutter defers positions, materialize_vertices must fill in the new vertices before the
+ * next cut.
+ * @return Number of tetrahedra that were cut, 0 if the cutter cannot defer positions
+ */
+template <class Mesh>
+int cut_mesh(
+    tetrahedron_mesh_cutter_t& cutter,
+    Mesh& mesh,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+    std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line)
+{
+    using traits = mesh_traits<Mesh>;
+
+    cutter.quality = {};
+    if (!cutter.can_defer_positions())
+        return 0;
+
+    Eigen::RowVector3d const min =
+        start_line.first.cwiseMin(start_line.second).cwiseMin(end_line.second).transpose();
+    Eigen::RowVector3d const max =
+        start_line.first.cwiseMax(start_line.second).cwiseMax(end_line.second).transpose();
+
+    auto& candidates = cutter.candidate_tetrahedra;
+    candidates.clear();
+    int const tetrahedron_count = traits::tetrahedron_count(mesh);
+    for (int t = 0; t < tetrahedron_count; ++t)
+    {
+        Eigen::RowVector4i const tetrahedron = traits::tetrahedron(mesh, t);
+        Eigen::RowVector3d tmin              = traits::vertex(mesh, tetrahedron(0));
+        Eigen::RowVector3d tmax              = tmin;
+        for (int j = 1; j < 4; ++j)
+        {
+            Eigen::RowVector3d const position = traits::vertex(mesh, tetrahedron(j));
+            tmin                              = tmin.cwiseMin(position);
+            tmax                              = tmax.cwiseMax(position);
+        }
+
+        bool const overlaps =
+            (tmin.array() <= max.array()).all() && (tmax.array() >= min.array()).all();
+        if (overlaps)
+            candidates.push_back(t);
+    }
+
+    int cut_count = 0;
+    cutter.begin_cut();
+    for (int const t : candidates)
+    {
+        if (cut_tetrahedron(cutter, mesh, t, start_line, end_line))
+            ++cut_count;
+    }
+    cutter.end_cut();
+
+    return cut_count;
+}
+
+} // namespace geometry
+
+#endif // TET_CUT_MESH_STORAGE_HPP
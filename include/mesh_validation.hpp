@@ -0,0 +1,244 @@
+#ifndef TET_CUT_MESH_VALIDATION_HPP
+#define TET_CUT_MESH_VALIDATION_HPP
+
+#include "mesh_primitives.hpp"
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <igl/parallel_for.h>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Violations of conformity found in a tetrahedral mesh. Conforming meshes, as checked with
+ * assert(validate_conformity(V, T).is_conforming()), have no violations.
+ */
+struct conformity_report_t
+{
+    // tetrahedra with non-positive signed volume
+    std::vector<int> inverted_tetrahedra{};
+    // pairs of tetrahedra with the same vertices
+    std::vector<std::pair<int, int>> duplicate_tetrahedra{};
+    // pairs of tetrahedra sharing a face with the same orientation
+    std::vector<std::pair<int, int>> inconsistently_oriented_faces{};
+    // tetrahedra whose face is shared by more than one other tetrahedron
+    std::vector<int> non_manifold_faces{};
+    // pairs of a vertex and a tetrahedron such that the vertex lies on a boundary face of the
+    // tetrahedron without being one of its vertices, i.e. T-junctions and unshared coincident
+    // vertices between neighbouring tetrahedra
+    std::vector<std::pair<int, int>> hanging_vertices{};
+
+    bool is_conforming() const
+    {
+        return inverted_tetrahedra.empty() && duplicate_tetrahedra.empty() &&
+               inconsistently_oriented_faces.empty() && non_manifold_faces.empty() &&
+               hanging_vertices.empty();
+    }
+};
+
+/**
+ * @brief
+ * Checks the conformity of the tetrahedral mesh (V,T). Face and tetrahedron keys are hashed and
+ * sorted in parallel to find duplicate tetrahedra, inconsistently oriented and non-manifold
+ * faces. Vertices are then binned in a uniform grid, which every boundary face queries in
+ * parallel for vertices lying on it, since boundary faces inside of the mesh stem from
+ * T-junctions or unshared coincident vertices.
+ * @param V Vertex positions
+ * @param T Tetrahedra
+ * @param tolerance Distance below which a vertex lies on a face, relative to the face's longest
+ * edge
+ * @return Violations, reported with tetrahedron and vertex indices
+ */
+conformity_report_t
+validate_conformity(Eigen::MatrixXd const& V, Eigen::MatrixXi const& T, double tolerance = 1e-9)
+{
+    conformity_report_t report{};
+    int const tetrahedron_count = static_cast<int>(T.rows());
+
+    auto const position = [&](int v) -> Eigen::Vector3d { return V.row(v).transpose(); };
+
+    report.inverted_tetrahedra =
+        detail::parallel_collect<int>(tetrahedron_count, [&](int t, std::vector<int>& items) {
+            Eigen::Vector3d const a = position(T(t, 0));
+            double const volume =
+                (position(T(t, 1)) - a).dot((position(T(t, 2)) - a).cross(position(T(t, 3)) - a));
+            if (!(volume > 0.))
+                items.push_back(t);
+        });
+
+    std::vector<std::array<int, 4u>> tetrahedron_keys(static_cast<std::size_t>(tetrahedron_count));
+    std::vector<std::uint64_t> tetrahedron_hashes(tetrahedron_keys.size());
+    igl::parallel_for(
+        tetrahedron_count,
+        [&](int t) {
+            std::array<int, 4u> key{T(t, 0), T(t, 1), T(t, 2), T(t, 3)};
+            std::sort(key.begin(), key.end());
+            tetrahedron_keys[t]   = key;
+            tetrahedron_hashes[t] = detail::hash_indices(key);
+        },
+        1000u);
+
+    detail::visit_equal_keys(tetrahedron_keys, tetrahedron_hashes, [&](int i, int j) {
+        report.duplicate_tetrahedra.push_back({std::min(i, j), std::max(i, j)});
+    });
+
+    // faces in counterclockwise order seen from outside of a positively oriented tetrahedron,
+    // such that a face shared by two tetrahedra appears with opposite orientations
+    std::array<std::array<int, 3u>, 4u> constexpr TF{{{0, 1, 3}, {1, 2, 3}, {2, 0, 3}, {0, 2, 1}}};
+
+    std::size_t const face_count = 4u * static_cast<std::size_t>(tetrahedron_count);
+    std::vector<std::array<int, 3u>> face_keys(face_count);
+    std::vector<std::uint64_t> face_hashes(face_count);
+    std::vector<std::uint8_t> face_parities(face_count);
+    igl::parallel_for(
+        tetrahedron_count,
+        [&](int t) {
+            for (int f = 0; f < 4; ++f)
+            {
+                std::array<int, 3u> key{T(t, TF[f][0]), T(t, TF[f][1]), T(t, TF[f][2])};
+                int const parity = detail::sort_face(key);
+
+                std::size_t const k = 4u * static_cast<std::size_t>(t) + f;
+                face_keys[k]        = key;
+                face_hashes[k]      = detail::hash_indices(key);
+                face_parities[k]    = static_cast<std::uint8_t>(parity);
+            }
+        },
+        1000u);
+
+    std::vector<int> face_neighbour_counts(face_count, 0);
+    detail::visit_equal_keys(face_keys, face_hashes, [&](int i, int j) {
+        ++face_neighbour_counts[i];
+        ++face_neighbour_counts[j];
+
+        int const ti = i / 4;
+        int const tj = j / 4;
+        if (face_parities[i] == face_parities[j])
+            report.inconsistently_oriented_faces.push_back({std::min(ti, tj), std::max(ti, tj)});
+    });
+
+    std::vector<int> boundary_faces{};
+    for (std::size_t k = 0u; k < face_count; ++k)
+    {
+        if (face_neighbour_counts[k] == 0)
+            boundary_faces.push_back(static_cast<int>(k));
+        else if (face_neighbour_counts[k] > 1)
+            report.non_manifold_faces.push_back(static_cast<int>(k / 4u));
+    }
+    report.non_manifold_faces.erase(
+        std::unique(report.non_manifold_faces.begin(), report.non_manifold_faces.end()),
+        report.non_manifold_faces.end());
+
+    if (boundary_faces.empty() || V.rows() == 0)
+        return report;
+
+    // vertices are binned in cells about the size of a boundary face, sorted by cell key
+    auto const face_vertices = [&](int k) {
+        int const t = k / 4;
+        int const f = k % 4;
+        return std::array<int, 3u>{T(t, TF[f][0]), T(t, TF[f][1]), T(t, TF[f][2])};
+    };
+
+    double edge_length_sum = 0.;
+    for (int const k : boundary_faces)
+    {
+        auto const face = face_vertices(k);
+        edge_length_sum += (position(face[1]) - position(face[0])).norm();
+    }
+
+    Eigen::RowVector3d const min = V.colwise().minCoeff();
+    double const cell_size =
+        std::max(edge_length_sum / static_cast<double>(boundary_faces.size()), 1e-12);
+    std::uint64_t constexpr max_cell = (1u << 21) - 1u;
+
+    auto const cell = [&](Eigen::Vector3d const& p, int d) {
+        double const c = std::floor((p(d) - min(d)) / cell_size);
+        return static_cast<std::uint64_t>(std::clamp(c, 0., static_cast<double>(max_cell)));
+    };
+    auto const cell_key = [](std::uint64_t x, std::uint64_t y, std::uint64_t z) {
+        return x | y << 21 | z << 42;
+    };
+
+    std::vector<std::uint64_t> vertex_keys(static_cast<std::size_t>(V.rows()));
+    igl::parallel_for(
+        V.rows(),
+        [&](Eigen::Index v) {
+            Eigen::Vector3d const p = position(static_cast<int>(v));
+            vertex_keys[v]          = cell_key(cell(p, 0), cell(p, 1), cell(p, 2));
+        },
+        1000u);
+
+    std::vector<int> const vertex_order = detail::parallel_argsort(vertex_keys);
+    std::vector<std::uint64_t> sorted_keys(vertex_keys.size());
+    for (std::size_t i = 0u; i < vertex_order.size(); ++i)
+        sorted_keys[i] = vertex_keys[vertex_order[i]];
+
+    report.hanging_vertices = detail::parallel_collect<std::pair<int, int>>(
+        static_cast<int>(boundary_faces.size()),
+        [&](int i, std::vector<std::pair<int, int>>& items) {
+            int const k     = boundary_faces[i];
+            auto const face = face_vertices(k);
+
+            Eigen::Vector3d const a = position(face[0]);
+            Eigen::Vector3d const b = position(face[1]);
+            Eigen::Vector3d const c = position(face[2]);
+            Eigen::Vector3d const n = (b - a).cross(c - a);
+
+            double const longest_edge =
+                std::max({(b - a).norm(), (c - b).norm(), (a - c).norm()});
+            double const epsilon = tolerance * longest_edge;
+            double const n2      = n.squaredNorm();
+            if (!(n2 > 0.))
+                return;
+
+            Eigen::Vector3d const lower = a.cwiseMin(b).cwiseMin(c).array() - epsilon;
+            Eigen::Vector3d const upper = a.cwiseMax(b).cwiseMax(c).array() + epsilon;
+
+            for (std::uint64_t z = cell(lower, 2); z <= cell(upper, 2); ++z)
+            {
+                for (std::uint64_t y = cell(lower, 1); y <= cell(upper, 1); ++y)
+                {
+                    auto const first = std::lower_bound(
+                        sorted_keys.begin(),
+                        sorted_keys.end(),
+                        cell_key(cell(lower, 0), y, z));
+                    auto const last = std::upper_bound(
+                        first,
+                        sorted_keys.end(),
+                        cell_key(cell(upper, 0), y, z));
+
+                    for (auto it = first; it != last; ++it)
+                    {
+                        int const v = vertex_order[it - sorted_keys.begin()];
+                        if (v == face[0] || v == face[1] || v == face[2])
+                            continue;
+
+                        Eigen::Vector3d const p = position(v);
+                        if (std::abs(n.dot(p - a)) > epsilon * std::sqrt(n2))
+                            continue;
+
+                        // barycentric coordinates of the projection of p onto the face
+                        double const u = n.dot((c - b).cross(p - b)) / n2;
+                        double const w = n.dot((a - c).cross(p - c)) / n2;
+                        double const s = 1. - u - w;
+
+                        if (u >= -tolerance && w >= -tolerance && s >= -tolerance)
+                            items.push_back({v, k / 4});
+                    }
+                }
+            }
+        });
+
+    return report;
+}
+
+} // namespace geometry
+
+#endif // TET_CUT_MESH_VALIDATION_HPP
@@ -0,0 +1,578 @@
+#ifndef TET_CUT_PARALLEL_CUT_HPP
+#define TET_CUT_PARALLEL_CUT_HPP
+
+#include "level_set_cut.hpp"
+#include "mesh_storage.hpp"
+#include "thread_pool.hpp"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+namespace detail {
+
+// upper bounds of the rows appended by one subdivision, i.e. of the 5 new vertices of case 4 and
+// their copies made by fracture, and of case 4's 9 children
+int constexpr max_appended_vertex_count      = 10;
+int constexpr max_appended_tetrahedron_count = 8;
+
+} // namespace detail
+
+/**
+ * @brief
+ * Cuts a single mesh with a cutting triangle on a work-stealing thread pool. Candidate
+ * tetrahedra are subdivided concurrently, each in a local copy of its four vertices, and their
+ * rows are then written into the mesh. The crossing of every mesh edge is computed once, from
+ * the edge's lower vertex index, and every crossed edge and face of the mesh, and its fracture
+ * copy, gets a single vertex row that all tetrahedra incident to it refer to.
+ *
+ * In deterministic mode, the new vertices are numbered in order of the crossed edges' keys,
+ * followed by the crossed faces and the copies, the children of every subdivision are placed
+ * after those of the candidates with lower row, and vertex sources, cut surface triangles and
+ * the delta are recorded in the same order, such that the output is bitwise identical for any
+ * thread count and scheduling. Otherwise, vertex rows are claimed by the first subdivision
+ * reaching them and children rows are reserved as subdivisions complete, which saves keeping
+ * all staged subdivisions until the end but makes the order of appended rows depend on
+ * scheduling.
+ */
+class parallel_mesh_cutter_t
+{
+  public:
+    /**
+     * @brief
+     * @param thread_count Number of worker threads
+     * @param parameters Cutter whose snapping and fracture parameters are used by all workers
+     */
+    explicit parallel_mesh_cutter_t(
+        std::size_t thread_count = std::max(1u, std::thread::hardware_concurrency()),
+        tetrahedron_mesh_cutter_t const& parameters = {})
+        : pool_{thread_count}, cutters_(pool_.thread_count()), worker_staged_(cutters_.size())
+    {
+        for (auto& cutter : cutters_)
+        {
+            cutter.snapping = parameters.snapping;
+            cutter.fracture = parameters.fracture;
+        }
+    }
+
+    // when enabled, the output does not depend on thread count and scheduling
+    bool deterministic{true};
+
+    // when set, the source of every vertex created by the cut is appended to it
+    std::vector<vertex_source_t>* vertex_sources{nullptr};
+
+    // when set, the children faces lying on the cutting surface are appended to it
+    std::vector<cut_surface_triangle_t>* cut_surface{nullptr};
+
+    // when set, the rows touched by the cut are accumulated in the delta
+    cut_delta_t* delta{nullptr};
+
+    std::size_t thread_count() const { return pool_.thread_count(); }
+
+    /**
+     * @brief
+     * Cuts every tetrahedron of the mesh (V,T) that is intersected by the triangle formed by
+     * start_line and end_line
+     * @return Number of tetrahedra that were cut
+     */
+    int cut(
+        Eigen::MatrixXd& V,
+        Eigen::MatrixXi& T,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line)
+    {
+        // only triangle cutting surfaces are supported, as in cut_tetrahedron
+        if (start_line.first != end_line.first ||
+            (start_line.second - start_line.first).normalized() ==
+                (end_line.second - end_line.first).normalized())
+            return 0;
+
+        for (auto& cutter : cutters_)
+        {
+            cutter.vertex_sources = vertex_sources;
+            cutter.cut_surface    = cut_surface;
+        }
+
+        find_candidates(V, T, start_line, end_line);
+        find_faces(T);
+        intersect_edges(V, T, start_line.first, start_line.second, end_line.second);
+
+        return deterministic ? cut_deterministic(V, T, start_line, end_line) :
+                               cut_unordered(V, T, start_line, end_line);
+    }
+
+  private:
+    static int constexpr block_size = 64;
+
+    template <class Task>
+    void run_blocks(int n, Task const& task)
+    {
+        std::size_t const block_count = static_cast<std::size_t>((n + block_size - 1) / block_size);
+        pool_.run(block_count, [&](std::size_t b, std::size_t worker) {
+            int const begin = static_cast<int>(b) * block_size;
+            int const end   = std::min(n, begin + block_size);
+            for (int i = begin; i < end; ++i)
+                task(i, worker);
+        });
+    }
+
+    void find_candidates(
+        Eigen::MatrixXd const& V,
+        Eigen::MatrixXi const& T,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line)
+    {
+        Eigen::RowVector3d const min =
+            start_line.first.cwiseMin(start_line.second).cwiseMin(end_line.second).transpose();
+        Eigen::RowVector3d const max =
+            start_line.first.cwiseMax(start_line.second).cwiseMax(end_line.second).transpose();
+
+        int const tetrahedron_count = static_cast<int>(T.rows());
+        overlaps_.assign(static_cast<std::size_t>(tetrahedron_count), 0u);
+        run_blocks(tetrahedron_count, [&](int t, std::size_t) {
+            Eigen::RowVector3d tmin = V.row(T(t, 0));
+            Eigen::RowVector3d tmax = tmin;
+            for (int j = 1; j < 4; ++j)
+            {
+                tmin = tmin.cwiseMin(V.row(T(t, j)));
+                tmax = tmax.cwiseMax(V.row(T(t, j)));
+            }
+
+            overlaps_[t] = (tmin.array() <= max.array()).all() &&
+                           (tmax.array() >= min.array()).all();
+        });
+
+        candidates_.clear();
+        for (int t = 0; t < tetrahedron_count; ++t)
+            if (overlaps_[t] != 0u)
+                candidates_.push_back(t);
+    }
+
+    // faces of the candidates as sorted vertex triples, which new vertices may lie on
+    void find_faces(Eigen::MatrixXi const& T)
+    {
+        face_keys_.clear();
+        for (int const t : candidates_)
+        {
+            for (int k = 0; k < 4; ++k)
+            {
+                std::array<int, 3u> face{T(t, (k + 1) % 4), T(t, (k + 2) % 4), T(t, (k + 3) % 4)};
+                detail::sort_face(face);
+                face_keys_.push_back(face);
+            }
+        }
+        std::sort(face_keys_.begin(), face_keys_.end());
+        face_keys_.erase(std::unique(face_keys_.begin(), face_keys_.end()), face_keys_.end());
+    }
+
+    void intersect_edges(
+        Eigen::MatrixXd const& V,
+        Eigen::MatrixXi const& T,
+        Eigen::Vector3d const& a,
+        Eigen::Vector3d const& b,
+        Eigen::Vector3d const& c)
+    {
+        edge_keys_.clear();
+        for (int const t : candidates_)
+            for (auto const& edge : detail::tetrahedron_edges)
+                edge_keys_.push_back(detail::edge_key(T(t, edge[0]), T(t, edge[1])));
+        std::sort(edge_keys_.begin(), edge_keys_.end());
+        edge_keys_.erase(std::unique(edge_keys_.begin(), edge_keys_.end()), edge_keys_.end());
+
+        edge_intersections_.resize(edge_keys_.size());
+        run_blocks(static_cast<int>(edge_keys_.size()), [&](int e, std::size_t) {
+            int const vi           = static_cast<int>(edge_keys_[e] >> 32);
+            int const vj           = static_cast<int>(edge_keys_[e] & 0xffffffffu);
+            edge_intersections_[e] = intersect_triangle_line_two_way(
+                a,
+                b,
+                c,
+                {V.row(vi).transpose(), V.row(vj).transpose()});
+        });
+    }
+
+    bool stage(
+        Eigen::MatrixXd const& V,
+        Eigen::MatrixXi const& T,
+        int tetrahedron,
+        std::size_t worker,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line,
+        detail::staged_subdivision_t& staged)
+    {
+        Eigen::RowVector4i const vertices = T.row(tetrahedron);
+        std::array<Eigen::RowVector3d, 4u> const positions{
+            V.row(vertices(0)),
+            V.row(vertices(1)),
+            V.row(vertices(2)),
+            V.row(vertices(3))};
+
+        std::byte edge_intersection_mask{0b00000000};
+        std::array<intersection_point_t, 6u> edge_intersections{};
+        for (int e = 0; e < 6; ++e)
+        {
+            auto const& edge = detail::tetrahedron_edges[e];
+            int const vi     = vertices(edge[0]);
+            int const vj     = vertices(edge[1]);
+            auto const it =
+                std::lower_bound(edge_keys_.begin(), edge_keys_.end(), detail::edge_key(vi, vj));
+            auto const& intersection = edge_intersections_[it - edge_keys_.begin()];
+            if (!intersection.intersects)
+                continue;
+
+            double const s = vi < vj ? intersection.t : 1. - intersection.t;
+
+            edge_intersection_mask |= std::byte{static_cast<unsigned char>(1u << e)};
+            edge_intersections[e] = {intersection.point, {edge[0], edge[1], -1}, {1. - s, s, 0.}};
+        }
+
+        auto const face_intersections = get_face_intersections(
+                                            positions[0].transpose(),
+                                            positions[1].transpose(),
+                                            positions[2].transpose(),
+                                            positions[3].transpose(),
+                                            start_line,
+                                            end_line)
+                                            .second;
+
+        Eigen::Vector3d const& a     = start_line.first;
+        Eigen::Vector3d const normal = (start_line.second - a).cross(end_line.second - a);
+
+        return detail::stage_subdivision(
+            cutters_[worker],
+            vertices,
+            positions,
+            staged,
+            [&](tetrahedron_mesh_cutter_t& cutter, Eigen::MatrixXd& SV, Eigen::MatrixXi& ST) {
+                auto const is_negative = [&](int t) {
+                    Eigen::Vector3d const barycenter =
+                        0.25 *
+                        (SV.row(ST(t, 0)) + SV.row(ST(t, 1)) + SV.row(ST(t, 2)) + SV.row(ST(t, 3)))
+                            .transpose();
+                    return normal.dot(barycenter - a) < 0.;
+                };
+
+                return subdivide_tetrahedron(
+                    cutter,
+                    SV,
+                    ST,
+                    0,
+                    edge_intersection_mask,
+                    edge_intersections,
+                    face_intersections,
+                    is_negative);
+            });
+    }
+
+    int slot_count() const { return 2 * static_cast<int>(edge_keys_.size() + face_keys_.size()); }
+
+    /**
+     * @brief
+     * Sets the shared vertices of a staged subdivision to the slots of its new vertices, i.e. to
+     * the indices of the crossed edges in edge_keys_, followed by those of the crossed faces in
+     * face_keys_, and, for fracture copies, followed by the slots of the copied vertices
+     */
+    void find_slots(detail::staged_subdivision_t& staged) const
+    {
+        int const edge_count = static_cast<int>(edge_keys_.size());
+        int const face_count = static_cast<int>(face_keys_.size());
+
+        std::size_t const vertex_count = static_cast<std::size_t>(staged.V.rows()) - 4u;
+        assert(staged.vertex_sources.size() == vertex_count);
+        staged.shared_vertices.resize(vertex_count);
+        for (std::size_t i = 0u; i < vertex_count; ++i)
+        {
+            std::size_t const original = detail::copied_vertex_source(staged, i);
+            if (original < i)
+            {
+                staged.shared_vertices[i] =
+                    edge_count + face_count + staged.shared_vertices[original];
+                continue;
+            }
+
+            vertex_source_t source = staged.vertex_sources[i];
+            for (int& parent : source.vertices)
+                if (parent >= 0)
+                    parent = staged.tetrahedron(parent);
+
+            std::array<int, 3u> const key = detail::intersection_key(source);
+            if (key[2] < 0)
+            {
+                auto const it = std::lower_bound(
+                    edge_keys_.begin(),
+                    edge_keys_.end(),
+                    detail::edge_key(key[0], key[1]));
+                staged.shared_vertices[i] = static_cast<int>(it - edge_keys_.begin());
+            }
+            else
+            {
+                auto const it = std::lower_bound(face_keys_.begin(), face_keys_.end(), key);
+                staged.shared_vertices[i] = edge_count + static_cast<int>(it - face_keys_.begin());
+            }
+        }
+    }
+
+    /**
+     * @brief
+     * Source of the vertex of the mesh at row vertex, which the j-th new vertex of a staged
+     * subdivision stands for, where copied_vertex is the row of the vertex it is a fracture copy
+     * of, if any
+     */
+    static vertex_source_t slot_source(
+        detail::staged_subdivision_t const& staged,
+        std::size_t j,
+        int vertex,
+        int copied_vertex)
+    {
+        vertex_source_t source = staged.vertex_sources[j];
+        source.vertex          = vertex;
+        if (source.is_copy())
+            source.copied_vertex = copied_vertex;
+        for (int& parent : source.vertices)
+            if (parent >= 0)
+                parent = staged.tetrahedron(parent);
+        return source;
+    }
+
+    void record(
+        int tetrahedron,
+        detail::staged_subdivision_t const& staged,
+        int first_vertex,
+        int first_tetrahedron)
+    {
+        if (cut_surface != nullptr)
+        {
+            cut_surface->insert(
+                cut_surface->end(),
+                staged.cut_surface.begin(),
+                staged.cut_surface.end());
+        }
+
+        if (delta != nullptr && staged.appended_tetrahedron_count() > 0)
+        {
+            delta->record(
+                {tetrahedron,
+                 staged.tetrahedron,
+                 first_tetrahedron,
+                 staged.appended_tetrahedron_count(),
+                 first_vertex,
+                 staged.appended_vertex_count()});
+        }
+    }
+
+    int cut_deterministic(
+        Eigen::MatrixXd& V,
+        Eigen::MatrixXi& T,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line)
+    {
+        int const candidate_count = static_cast<int>(candidates_.size());
+        if (staged_.size() < candidates_.size())
+            staged_.resize(candidates_.size());
+        results_.assign(candidates_.size(), 0u);
+
+        run_blocks(candidate_count, [&](int i, std::size_t worker) {
+            results_[i] = stage(V, T, candidates_[i], worker, start_line, end_line, staged_[i]);
+            if (results_[i] != 0u)
+                find_slots(staged_[i]);
+        });
+
+        // every slot's vertex is taken from the first candidate referring to it, and children
+        // appended for the i-th candidate follow those of the candidates before it
+        int const vertex_count      = static_cast<int>(V.rows());
+        int const tetrahedron_count = static_cast<int>(T.rows());
+        slot_users_.assign(static_cast<std::size_t>(slot_count()), {-1, -1});
+        first_tetrahedra_.resize(candidates_.size());
+        int next_tetrahedron = tetrahedron_count;
+        int cut_count        = 0;
+        for (int i = 0; i < candidate_count; ++i)
+        {
+            first_tetrahedra_[i] = next_tetrahedron;
+            if (results_[i] == 0u)
+                continue;
+
+            ++cut_count;
+            next_tetrahedron += staged_[i].appended_tetrahedron_count();
+            auto const& slots = staged_[i].shared_vertices;
+            for (int j = 0; j < static_cast<int>(slots.size()); ++j)
+                if (slot_users_[slots[j]].first < 0)
+                    slot_users_[slots[j]] = {i, j};
+        }
+
+        slot_rows_.assign(slot_users_.size(), -1);
+        int next_vertex = vertex_count;
+        for (std::size_t s = 0u; s < slot_users_.size(); ++s)
+            if (slot_users_[s].first >= 0)
+                slot_rows_[s] = next_vertex++;
+
+        V.conservativeResize(next_vertex, Eigen::NoChange);
+        T.conservativeResize(next_tetrahedron, Eigen::NoChange);
+
+        // the slots of fracture copies follow those of the edges and faces, in the same order
+        int const copy_slot_offset = static_cast<int>(edge_keys_.size() + face_keys_.size());
+        for (std::size_t s = 0u; s < slot_users_.size(); ++s)
+        {
+            auto const [i, j] = slot_users_[s];
+            if (i < 0)
+                continue;
+
+            auto const& staged = staged_[i];
+            V.row(slot_rows_[s]) = staged.V.row(4 + j);
+            if (vertex_sources != nullptr)
+            {
+                int const copied_slot = static_cast<int>(s) - copy_slot_offset;
+                vertex_sources->push_back(slot_source(
+                    staged,
+                    j,
+                    slot_rows_[s],
+                    copied_slot >= 0 ? slot_rows_[copied_slot] : -1));
+            }
+        }
+
+        eigen_mesh_t mesh{V, T};
+        run_blocks(candidate_count, [&](int i, std::size_t) {
+            if (results_[i] != 0u)
+            {
+                for (int& v : staged_[i].shared_vertices)
+                    v = slot_rows_[v];
+
+                detail::commit_subdivision(
+                    mesh,
+                    candidates_[i],
+                    staged_[i],
+                    next_vertex,
+                    first_tetrahedra_[i],
+                    true);
+            }
+        });
+
+        if (delta != nullptr)
+            delta->record_vertices(vertex_count, next_vertex - vertex_count);
+
+        for (int i = 0; i < candidate_count; ++i)
+            if (results_[i] != 0u)
+                record(candidates_[i], staged_[i], next_vertex, first_tetrahedra_[i]);
+
+        return cut_count;
+    }
+
+    int cut_unordered(
+        Eigen::MatrixXd& V,
+        Eigen::MatrixXi& T,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& start_line,
+        std::pair<Eigen::Vector3d, Eigen::Vector3d> const& end_line)
+    {
+        int const candidate_count   = static_cast<int>(candidates_.size());
+        int const vertex_count      = static_cast<int>(V.rows());
+        int const tetrahedron_count = static_cast<int>(T.rows());
+        V.conservativeResize(
+            vertex_count + candidate_count * detail::max_appended_vertex_count,
+            Eigen::NoChange);
+        T.conservativeResize(
+            tetrahedron_count + candidate_count * detail::max_appended_tetrahedron_count,
+            Eigen::NoChange);
+
+        // row of every slot's vertex, -1 while unclaimed and -2 while its claimer writes it
+        std::vector<std::atomic<int>> slot_rows(static_cast<std::size_t>(slot_count()));
+        for (auto& row : slot_rows)
+            row.store(-1, std::memory_order_relaxed);
+
+        std::atomic<int> next_vertex{vertex_count};
+        std::atomic<int> next_tetrahedron{tetrahedron_count};
+        std::atomic<int> cut_count{0};
+        std::mutex mutex{};
+        eigen_mesh_t mesh{V, T};
+        run_blocks(candidate_count, [&](int i, std::size_t worker) {
+            auto& staged = worker_staged_[worker];
+            if (!stage(V, T, candidates_[i], worker, start_line, end_line, staged))
+                return;
+
+            ++cut_count;
+            int const appended_tetrahedron_count = staged.appended_tetrahedron_count();
+            if (appended_tetrahedron_count == 0)
+                return;
+
+            assert(staged.V.rows() - 4 <= detail::max_appended_vertex_count);
+            assert(appended_tetrahedron_count <= detail::max_appended_tetrahedron_count);
+            find_slots(staged);
+            for (std::size_t j = 0u; j < staged.shared_vertices.size(); ++j)
+            {
+                auto& slot_row = slot_rows[staged.shared_vertices[j]];
+                int row        = -1;
+                if (slot_row.compare_exchange_strong(row, -2, std::memory_order_acquire))
+                {
+                    row = next_vertex.fetch_add(1);
+                    V.row(row) = staged.V.row(4 + static_cast<int>(j));
+                    {
+                        std::lock_guard<std::mutex> lock{mutex};
+                        if (vertex_sources != nullptr)
+                        {
+                            std::size_t const original = detail::copied_vertex_source(staged, j);
+                            vertex_sources->push_back(slot_source(
+                                staged,
+                                j,
+                                row,
+                                original < j ? staged.shared_vertices[original] : -1));
+                        }
+                        if (delta != nullptr)
+                            delta->record_vertices(row, 1);
+                    }
+                    slot_row.store(row, std::memory_order_release);
+                }
+
+                while (row < 0)
+                {
+                    row = slot_row.load(std::memory_order_acquire);
+                    if (row < 0)
+                        std::this_thread::yield();
+                }
+                staged.shared_vertices[j] = row;
+            }
+
+            int const first_tetrahedron = next_tetrahedron.fetch_add(appended_tetrahedron_count);
+            detail::commit_subdivision(
+                mesh,
+                candidates_[i],
+                staged,
+                next_vertex.load(),
+                first_tetrahedron,
+                true);
+
+            std::lock_guard<std::mutex> lock{mutex};
+            record(candidates_[i], staged, next_vertex.load(), first_tetrahedron);
+        });
+
+        V.conservativeResize(next_vertex.load(), Eigen::NoChange);
+        T.conservativeResize(next_tetrahedron.load(), Eigen::NoChange);
+        return cut_count.load();
+    }
+
+    work_stealing_thread_pool_t pool_;
+    std::vector<tetrahedron_mesh_cutter_t> cutters_;
+    std::vector<detail::staged_subdivision_t> worker_staged_;
+
+    // scratch buffers, kept across cuts to avoid reallocations
+    std::vector<std::uint8_t> overlaps_{};
+    std::vector<int> candidates_{};
+    std::vector<std::uint64_t> edge_keys_{};
+    std::vector<std::array<int, 3u>> face_keys_{};
+    std::vector<line_triangle_intersection_t> edge_intersections_{};
+    std::vector<detail::staged_subdivision_t> staged_{};
+    std::vector<std::uint8_t> results_{};
+    std::vector<std::pair<int, int>> slot_users_{};
+    std::vector<int> slot_rows_{};
+    std::vector<int> first_tetrahedra_{};
+};
+
+} // namespace geometry
+
+#endif // TET_CUT_PARALLEL_CUT_HPP
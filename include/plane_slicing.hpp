@@ -0,0 +1,293 @@
+#ifndef TET_CUT_PLANE_SLICING_HPP
+#define TET_CUT_PLANE_SLICING_HPP
+
+#include "attribute_transfer.hpp"
+#include "cut_tetrahedron.hpp"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <igl/parallel_for.h>
+#include <vector>
+
+namespace geometry {
+
+namespace detail {
+
+/**
+ * @brief
+ * Orders the local vertices of a tetrahedron by an even permutation, which preserves its
+ * orientation, starting with the given two distinct local vertices
+ */
+std::array<int, 4u> even_permutation(int first, int second)
+{
+    std::array<std::array<int, 4u>, 4u> constexpr permutations{
+        {{0, 1, 2, 3}, {1, 0, 3, 2}, {2, 3, 0, 1}, {3, 2, 1, 0}}};
+
+    std::array<int, 4u> p = permutations[first];
+    while (p[1] != second)
+        p = {p[0], p[2], p[3], p[1]};
+    return p;
+}
+
+/**
+ * @brief
+ * Number of children of a tetrahedron sliced by a plane, given the sides of its vertices, -1, 0
+ * or 1 for vertices below, on or above the plane
+ */
+int slicing_child_count(std::array<int, 4u> const& sides)
+{
+    int const negative_count = static_cast<int>(std::count(sides.begin(), sides.end(), -1));
+    int const positive_count = static_cast<int>(std::count(sides.begin(), sides.end(), 1));
+    if (negative_count == 0 || positive_count == 0)
+        return 0;
+    if (negative_count == 2 && positive_count == 2)
+        return 6;
+    if (negative_count + positive_count == 4)
+        return 4;
+    return negative_count + positive_count;
+}
+
+/**
+ * @brief
+ * Slices a positively oriented tetrahedron with the given vertices and sides, -1, 0 or 1 for
+ * vertices below, on or above the plane. Only edges whose vertices lie strictly on opposite
+ * sides are crossed, at the vertex edge_vertex(i, j) for local vertices i and j, and the prisms
+ * and pyramids left by the crossings are split along the diagonals through their lowest vertex.
+ * @return Number of children written to children
+ */
+template <class EdgeVertex>
+int slice_tetrahedron(
+    Eigen::RowVector4i const& vertices,
+    std::array<int, 4u> const& sides,
+    EdgeVertex const& edge_vertex,
+    std::array<Eigen::RowVector4i, 6u>& children)
+{
+    auto const less = [](int vi, int vj) { return vi < vj; };
+
+    std::array<int, 4u> order{0, 1, 2, 3};
+    std::sort(order.begin(), order.end(), [&](int i, int j) { return sides[i] < sides[j]; });
+    int const negative_count = static_cast<int>(std::count(sides.begin(), sides.end(), -1));
+    int const positive_count = static_cast<int>(std::count(sides.begin(), sides.end(), 1));
+    if (negative_count == 0 || positive_count == 0)
+        return 0;
+
+    // p[0] is alone on its side of the plane, or shares it with p[1] when the plane separates
+    // two edges
+    int const first  = negative_count == 1 ? order[0] : order[3];
+    int const second = negative_count == 2 && positive_count == 2 ? order[2] :
+                       negative_count == 1                        ? order[3] :
+                                                                    order[0];
+    std::array<int, 4u> p = even_permutation(first, second);
+    if (negative_count + positive_count == 3)
+    {
+        // the vertex on the plane goes last, which keeps the permutation even
+        while (sides[p[3]] != 0)
+            p = {p[0], p[2], p[3], p[1]};
+    }
+
+    int const v0 = vertices(p[0]);
+    int const v1 = vertices(p[1]);
+    int const v2 = vertices(p[2]);
+    int const v3 = vertices(p[3]);
+
+    if (negative_count + positive_count == 2)
+    {
+        // v2 and v3 lie on the plane, which splits edge (v0,v1)
+        int const e01 = edge_vertex(p[0], p[1]);
+        children[0]   = Eigen::RowVector4i{v0, e01, v2, v3};
+        children[1]   = Eigen::RowVector4i{e01, v1, v2, v3};
+        return 2;
+    }
+
+    if (negative_count + positive_count == 3)
+    {
+        // v3 lies on the plane, which cuts v0 off and leaves a pyramid with apex v3
+        int const e01      = edge_vertex(p[0], p[1]);
+        int const e02      = edge_vertex(p[0], p[2]);
+        auto const pyramid = split_pyramid(v3, {e02, v2, v1, e01}, less);
+        children[0]        = Eigen::RowVector4i{v0, e01, e02, v3};
+        children[1]        = pyramid[0];
+        children[2]        = pyramid[1];
+        return 3;
+    }
+
+    if (negative_count == 2 && positive_count == 2)
+    {
+        // the plane separates edge (v0,v1) from edge (v2,v3), leaving a prism on either side
+        int const e02       = edge_vertex(p[0], p[2]);
+        int const e03       = edge_vertex(p[0], p[3]);
+        int const e12       = edge_vertex(p[1], p[2]);
+        int const e13       = edge_vertex(p[1], p[3]);
+        auto const prism_01 = split_prism({v0, e02, e03, v1, e12, e13}, less);
+        auto const prism_23 = split_prism({v2, e02, e12, v3, e03, e13}, less);
+        std::copy(prism_01.begin(), prism_01.end(), children.begin());
+        std::copy(prism_23.begin(), prism_23.end(), children.begin() + 3);
+        return 6;
+    }
+
+    // v0 is cut off, leaving a prism between the cut and face (v1,v3,v2)
+    int const e01    = edge_vertex(p[0], p[1]);
+    int const e02    = edge_vertex(p[0], p[2]);
+    int const e03    = edge_vertex(p[0], p[3]);
+    auto const prism = split_prism({v1, v3, v2, e01, e03, e02}, less);
+    children[0]      = Eigen::RowVector4i{v0, e01, e02, e03};
+    std::copy(prism.begin(), prism.end(), children.begin() + 1);
+    return 4;
+}
+
+} // namespace detail
+
+/**
+ * @brief
+ * Slices the whole mesh (V,T) with the infinite plane through point with the given normal. Signed
+ * distances to the plane are computed over the columns of V, which Eigen stores as separate
+ * coordinate arrays, in vectorized and parallel blocks. Every vertex lies below, on or above the
+ * plane, and every edge whose vertices lie strictly on opposite sides is crossed by a single new
+ * vertex, which all tetrahedra around the edge share. All subdivisions are written in parallel
+ * after a single resize of V and T.
+ *
+ * As with the cutter, the subdivided tetrahedron's row holds its first child and the others are
+ * appended. New vertices are numbered in order of their edges' keys, and crossings are computed
+ * from the edge's lower vertex index. Vertices on the plane already separate its sides, such that
+ * tetrahedra touching the plane with a vertex, edge or face are not cut and no crossing is
+ * created at them. Quadrilateral faces are split along their diagonal through their lowest
+ * vertex, such that the sliced mesh is conforming.
+ * @param V Vertex positions
+ * @param T Tetrahedra
+ * @param point Point on the plane
+ * @param normal Normal of the plane
+ * @param vertex_sources If not null, the sources of the new vertices are appended to it
+ * @return Number of tetrahedra that were cut
+ */
+int slice_mesh(
+    Eigen::MatrixXd& V,
+    Eigen::MatrixXi& T,
+    Eigen::Vector3d const& point,
+    Eigen::Vector3d const& normal,
+    std::vector<vertex_source_t>* vertex_sources = nullptr)
+{
+    int const vertex_count      = static_cast<int>(V.rows());
+    int const tetrahedron_count = static_cast<int>(T.rows());
+    int constexpr block_size    = 1 << 14;
+
+    Eigen::VectorXd D(vertex_count);
+    double const offset = normal.dot(point);
+    igl::parallel_for((vertex_count + block_size - 1) / block_size, [&](int b) {
+        int const begin = b * block_size;
+        int const size  = std::min(block_size, vertex_count - begin);
+
+        D.segment(begin, size).array() = V.col(0).segment(begin, size).array() * normal(0) +
+                                         V.col(1).segment(begin, size).array() * normal(1) +
+                                         V.col(2).segment(begin, size).array() * normal(2) -
+                                         offset;
+    });
+
+    auto const side = [&](int v) { return D(v) < 0. ? -1 : D(v) > 0. ? 1 : 0; };
+
+    std::vector<std::uint8_t> child_counts(static_cast<std::size_t>(tetrahedron_count));
+    igl::parallel_for(
+        tetrahedron_count,
+        [&](int t) {
+            std::array<int, 4u> const sides{
+                side(T(t, 0)),
+                side(T(t, 1)),
+                side(T(t, 2)),
+                side(T(t, 3))};
+            child_counts[t] = static_cast<std::uint8_t>(detail::slicing_child_count(sides));
+        },
+        1000u);
+
+    std::vector<std::uint64_t> edge_keys = detail::parallel_collect<std::uint64_t>(
+        tetrahedron_count,
+        [&](int t, std::vector<std::uint64_t>& keys) {
+            if (child_counts[t] == 0u)
+                return;
+
+            for (auto const& edge : detail::tetrahedron_edges)
+            {
+                int const vi = T(t, edge[0]);
+                int const vj = T(t, edge[1]);
+                if (side(vi) * side(vj) < 0)
+                    keys.push_back(detail::edge_key(vi, vj));
+            }
+        });
+    std::sort(edge_keys.begin(), edge_keys.end());
+    edge_keys.erase(std::unique(edge_keys.begin(), edge_keys.end()), edge_keys.end());
+
+    std::vector<int> sliced_tetrahedra{};
+    std::vector<int> first_new_tetrahedra{};
+    int new_tetrahedron_count = 0;
+    for (int t = 0; t < tetrahedron_count; ++t)
+    {
+        if (child_counts[t] == 0u)
+            continue;
+
+        sliced_tetrahedra.push_back(t);
+        first_new_tetrahedra.push_back(tetrahedron_count + new_tetrahedron_count);
+        new_tetrahedron_count += child_counts[t] - 1;
+    }
+
+    int const new_vertex_count = static_cast<int>(edge_keys.size());
+    V.conservativeResize(vertex_count + new_vertex_count, Eigen::NoChange);
+    T.conservativeResize(tetrahedron_count + new_tetrahedron_count, Eigen::NoChange);
+
+    std::size_t const first_source = vertex_sources != nullptr ? vertex_sources->size() : 0u;
+    if (vertex_sources != nullptr)
+        vertex_sources->resize(first_source + static_cast<std::size_t>(new_vertex_count));
+
+    igl::parallel_for(
+        new_vertex_count,
+        [&](int e) {
+            int const vi   = static_cast<int>(edge_keys[e] >> 32);
+            int const vj   = static_cast<int>(edge_keys[e] & 0xffffffffu);
+            double const s = D(vi) / (D(vi) - D(vj));
+            int const v    = vertex_count + e;
+
+            V.row(v) = (1. - s) * V.row(vi) + s * V.row(vj);
+            if (vertex_sources != nullptr)
+            {
+                (*vertex_sources)[first_source + static_cast<std::size_t>(e)] =
+                    vertex_source_t{v, {vi, vj, -1}, {1. - s, s, 0.}};
+            }
+        },
+        1000u);
+
+    igl::parallel_for(
+        static_cast<int>(sliced_tetrahedra.size()),
+        [&](int i) {
+            int const t                       = sliced_tetrahedra[i];
+            Eigen::RowVector4i const vertices = T.row(t);
+
+            auto const edge_vertex = [&](int li, int lj) {
+                auto const it = std::lower_bound(
+                    edge_keys.begin(),
+                    edge_keys.end(),
+                    detail::edge_key(vertices(li), vertices(lj)));
+                return vertex_count + static_cast<int>(it - edge_keys.begin());
+            };
+
+            std::array<int, 4u> const sides{
+                side(vertices(0)),
+                side(vertices(1)),
+                side(vertices(2)),
+                side(vertices(3))};
+
+            std::array<Eigen::RowVector4i, 6u> children{};
+            int const child_count =
+                detail::slice_tetrahedron(vertices, sides, edge_vertex, children);
+            for (int c = 0; c < child_count; ++c)
+            {
+                int const row = c == 0 ? t : first_new_tetrahedra[i] + c - 1;
+                T.row(row)    = children[c];
+            }
+        },
+        1000u);
+
+    return static_cast<int>(sliced_tetrahedra.size());
+}
+
+} // namespace geometry
+
+#endif // TET_CUT_PLANE_SLICING_HPP
@@ -0,0 +1,493 @@
+#ifndef TET_CUT_POINT_LOCATION_HPP
+#define TET_CUT_POINT_LOCATION_HPP
+
+#include "cut_journal.hpp"
+#include "mesh_primitives.hpp"
+#include "mesh_reordering.hpp"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <igl/parallel_for.h>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Tetrahedron containing a point and the point's barycentric coordinates with respect to it, or
+ * tetrahedron = -1 if no tetrahedron contains the point
+ */
+struct point_location_t
+{
+    int tetrahedron{-1};
+    Eigen::RowVector4d barycentric{Eigen::RowVector4d::Zero()};
+    // number of tetrahedra visited by the adjacency walk
+    int walk_step_count{0};
+    // true if the walk found the tetrahedron, false if the grid was queried
+    bool is_walked{false};
+};
+
+/**
+ * @brief
+ * Totals over a batch of point location queries
+ */
+struct point_location_statistics_t
+{
+    std::int64_t walk_step_count{0};
+    // queries without hint, and walks that left the mesh or exceeded max_walk_steps
+    int index_query_count{0};
+    int outside_count{0};
+};
+
+/**
+ * @brief
+ * Point location in a tetrahedral mesh. Queries with a hint, e.g. the tetrahedron that
+ * contained the point in the previous frame, walk from the hint towards the point across the
+ * faces whose barycentric coordinate is most negative, which takes a handful of steps when
+ * points move coherently. Queries without hint, and walks that reach a face without neighbour
+ * or exceed max_walk_steps, are answered by a uniform grid of the tetrahedra's bounding boxes.
+ *
+ * Faces separated by fracture have no neighbour, such that walks stop at them and fall back to
+ * the grid. Queries read the current vertex positions, but the grid and the face adjacency are
+ * those of the mesh the locator was built or last updated for, so the locator must be updated
+ * after cuts and rebuilt after deformations that move tetrahedra out of their grid cells.
+ */
+class point_locator_t
+{
+  public:
+    int max_walk_steps{64};
+    // largest magnitude of negative barycentric coordinates of points inside of a tetrahedron
+    double tolerance{1e-9};
+
+    point_locator_t() = default;
+
+    /**
+     * @brief
+     * Builds the face adjacency of (V,T) and bins the tetrahedra's bounding boxes into a grid of
+     * about as many cells as there are tetrahedra
+     * @param V Vertex positions
+     * @param T Tetrahedra
+     */
+    point_locator_t(Eigen::MatrixXd const& V, Eigen::MatrixXi const& T)
+    {
+        build_adjacency(T);
+        build_grid(V, T);
+    }
+
+    int tetrahedron_count() const { return static_cast<int>(adjacency_.rows()); }
+
+    /**
+     * @brief
+     * Updates the locator after cuts of the mesh it was built for, whose changes were recorded
+     * in delta since the previous build or update. Only the faces of removed and added
+     * tetrahedra, and of their unchanged neighbours, are matched again, and the appended
+     * children are merged into the grid cells overlapped by their bounding boxes. Rows that now
+     * hold a child keep the cells of the tetrahedron they held, which contain the child.
+     * @param V Vertex positions
+     * @param T Tetrahedra after the cuts
+     * @param delta Changes made by the cuts
+     */
+    void update(Eigen::MatrixXd const& V, Eigen::MatrixXi const& T, cut_delta_t const& delta)
+    {
+        int const previous_count = tetrahedron_count();
+        if (previous_count == 0 || cell_offsets_.empty())
+        {
+            build_adjacency(T);
+            build_grid(V, T);
+            return;
+        }
+
+        std::vector<int> rows = delta.removed_tetrahedra();
+        for (auto const& [first, end] : delta.added_tetrahedra())
+            for (int t = first; t < end; ++t)
+                rows.push_back(t);
+
+        std::vector<std::uint8_t> is_changed(static_cast<std::size_t>(T.rows()), 0u);
+        for (int const t : rows)
+            is_changed[t] = 1u;
+
+        adjacency_.conservativeResize(T.rows(), Eigen::NoChange);
+        adjacency_.bottomRows(T.rows() - previous_count).setConstant(-1);
+
+        // faces of the changed rows, and faces of unchanged neighbours of removed tetrahedra
+        std::vector<int> faces{};
+        faces.reserve(8u * rows.size());
+        for (int const t : rows)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                int const neighbour = adjacency_(t, j);
+                if (neighbour < 0 || is_changed[neighbour] != 0u)
+                    continue;
+
+                for (int k = 0; k < 4; ++k)
+                {
+                    if (adjacency_(neighbour, k) == t)
+                    {
+                        adjacency_(neighbour, k) = -1;
+                        faces.push_back(4 * neighbour + k);
+                    }
+                }
+            }
+
+            adjacency_.row(t).setConstant(-1);
+            for (int j = 0; j < 4; ++j)
+                faces.push_back(4 * t + j);
+        }
+        connect_faces(T, faces);
+
+        // (cell, tetrahedron) pairs of the appended children, merged into the compressed rows
+        std::vector<entry_t> pairs{};
+        for (int const t : rows)
+            if (t >= previous_count)
+                add_cells(V, T, t, pairs);
+        std::sort(pairs.begin(), pairs.end());
+
+        std::vector<int> cell_tetrahedra(cell_tetrahedra_.size() + pairs.size());
+        std::size_t const cell_count = cell_offsets_.size() - 1u;
+        int next                     = 0;
+        std::size_t i                = 0u;
+        for (std::size_t k = 0u; k < cell_count; ++k)
+        {
+            int const begin  = cell_offsets_[k];
+            int const end    = cell_offsets_[k + 1u];
+            cell_offsets_[k] = next;
+            for (int c = begin; c < end; ++c)
+                cell_tetrahedra[next++] = cell_tetrahedra_[c];
+            for (; i < pairs.size() && pairs[i].first == k; ++i)
+                cell_tetrahedra[next++] = pairs[i].second;
+        }
+        cell_offsets_[cell_count] = next;
+        cell_tetrahedra_          = std::move(cell_tetrahedra);
+    }
+
+    /**
+     * @brief
+     * Neighbours of every tetrahedron, where column j is the tetrahedron sharing the face
+     * opposite of vertex j, or -1 on the boundary
+     */
+    Eigen::MatrixXi const& adjacency() const { return adjacency_; }
+
+    /**
+     * @brief
+     * Locates p by walking from hint, or by querying the grid if hint is -1 or the walk fails
+     * @param V Vertex positions
+     * @param T Tetrahedra
+     * @param p Query point
+     * @param hint Tetrahedron to start the walk from, e.g. the previous location of p
+     */
+    point_location_t locate(
+        Eigen::MatrixXd const& V,
+        Eigen::MatrixXi const& T,
+        Eigen::RowVector3d const& p,
+        int hint = -1) const
+    {
+        int walk_step_count = 0;
+        if (hint >= 0 && hint < tetrahedron_count())
+        {
+            point_location_t const location = walk(V, T, p, hint);
+            if (location.tetrahedron >= 0)
+                return location;
+            walk_step_count = location.walk_step_count;
+        }
+
+        point_location_t location = find(V, T, p);
+        location.walk_step_count  = walk_step_count;
+        return location;
+    }
+
+    /**
+     * @brief
+     * Locates the rows of P in parallel
+     * @param V Vertex positions
+     * @param T Tetrahedra
+     * @param P Query points
+     * @param tetrahedra Hints on input, either empty or one per query point with -1 for no hint,
+     * and containing tetrahedra or -1 on output
+     * @param barycentric If not null, barycentric coordinates of the query points in their
+     * containing tetrahedra
+     * @return Totals over the queries
+     */
+    point_location_statistics_t locate(
+        Eigen::MatrixXd const& V,
+        Eigen::MatrixXi const& T,
+        Eigen::MatrixXd const& P,
+        Eigen::VectorXi& tetrahedra,
+        Eigen::MatrixXd* barycentric = nullptr) const
+    {
+        if (tetrahedra.size() != P.rows())
+            tetrahedra = Eigen::VectorXi::Constant(P.rows(), -1);
+        if (barycentric != nullptr)
+            barycentric->resize(P.rows(), 4);
+
+        std::atomic<std::int64_t> walk_step_count{0};
+        std::atomic<int> index_query_count{0};
+        std::atomic<int> outside_count{0};
+
+        int constexpr block_size = 256;
+        int const query_count    = static_cast<int>(P.rows());
+        igl::parallel_for((query_count + block_size - 1) / block_size, [&](int b) {
+            int const begin = b * block_size;
+            int const end   = std::min(query_count, begin + block_size);
+
+            point_location_statistics_t block{};
+            for (int i = begin; i < end; ++i)
+            {
+                int const hint                  = tetrahedra(i);
+                point_location_t const location = locate(V, T, P.row(i), hint);
+                tetrahedra(i)                   = location.tetrahedron;
+                if (barycentric != nullptr)
+                    barycentric->row(i) = location.barycentric;
+
+                block.walk_step_count += location.walk_step_count;
+                if (!location.is_walked)
+                    ++block.index_query_count;
+                if (location.tetrahedron < 0)
+                    ++block.outside_count;
+            }
+
+            walk_step_count += block.walk_step_count;
+            index_query_count += block.index_query_count;
+            outside_count += block.outside_count;
+        });
+
+        return {walk_step_count.load(), index_query_count.load(), outside_count.load()};
+    }
+
+  private:
+    /**
+     * @brief
+     * Visibility walk from the tetrahedron start towards p, returning tetrahedron = -1 if it
+     * reaches a face without neighbour or exceeds max_walk_steps
+     */
+    point_location_t walk(
+        Eigen::MatrixXd const& V,
+        Eigen::MatrixXi const& T,
+        Eigen::RowVector3d const& p,
+        int start) const
+    {
+        point_location_t location{};
+        int t        = start;
+        int previous = -1;
+        while (location.walk_step_count < max_walk_steps)
+        {
+            ++location.walk_step_count;
+            Eigen::RowVector4d const coordinates =
+                detail::tetrahedron_barycentric_coordinates(p, V, T.row(t));
+            if (coordinates.minCoeff() >= -tolerance)
+            {
+                location.tetrahedron = t;
+                location.barycentric = coordinates;
+                location.is_walked   = true;
+                return location;
+            }
+
+            // crosses the face with the most negative coordinate that leads to a neighbour other
+            // than the tetrahedron the walk came from, which breaks two-cycles on flat pairs
+            int next       = -1;
+            double minimum = -tolerance;
+            for (int j = 0; j < 4; ++j)
+            {
+                int const neighbour = adjacency_(t, j);
+                if (coordinates(j) < minimum && neighbour >= 0 && neighbour != previous)
+                {
+                    next    = neighbour;
+                    minimum = coordinates(j);
+                }
+            }
+            if (next < 0)
+                break;
+
+            previous = t;
+            t        = next;
+        }
+
+        return location;
+    }
+
+    /**
+     * @brief
+     * Tests the tetrahedra binned in the grid cell of p, returning the one p is deepest inside of
+     */
+    point_location_t
+    find(Eigen::MatrixXd const& V, Eigen::MatrixXi const& T, Eigen::RowVector3d const& p) const
+    {
+        point_location_t location{};
+        if (cell_offsets_.empty())
+            return location;
+
+        // points on the bounding box's max faces fall into the last cells, as in build_grid
+        std::array<int, 3u> cell{};
+        for (int d = 0; d < 3; ++d)
+        {
+            if (!(p(d) >= min_(d) && p(d) <= max_(d)))
+                return location;
+
+            double const c = std::floor((p(d) - min_(d)) / cell_size_);
+            cell[d] = static_cast<int>(std::min(c, static_cast<double>(resolution_[d] - 1)));
+        }
+
+        std::size_t const k = cell_index(cell[0], cell[1], cell[2]);
+        double best         = -std::numeric_limits<double>::infinity();
+        for (int i = cell_offsets_[k]; i < cell_offsets_[k + 1u]; ++i)
+        {
+            int const t = cell_tetrahedra_[i];
+            Eigen::RowVector4d const coordinates =
+                detail::tetrahedron_barycentric_coordinates(p, V, T.row(t));
+            if (coordinates.minCoeff() >= -tolerance && coordinates.minCoeff() > best)
+            {
+                location.tetrahedron = t;
+                location.barycentric = coordinates;
+                best                 = coordinates.minCoeff();
+            }
+        }
+
+        return location;
+    }
+
+    void build_adjacency(Eigen::MatrixXi const& T)
+    {
+        int const tetrahedron_count = static_cast<int>(T.rows());
+        adjacency_.setConstant(tetrahedron_count, 4, -1);
+
+        std::vector<int> faces(4u * static_cast<std::size_t>(tetrahedron_count));
+        std::iota(faces.begin(), faces.end(), 0);
+        connect_faces(T, faces);
+    }
+
+    /**
+     * @brief
+     * Makes the tetrahedra neighbours across the equal faces among the given faces, where face
+     * 4*t+j is the face of tetrahedron t opposite of its vertex j
+     */
+    void connect_faces(Eigen::MatrixXi const& T, std::vector<int> const& faces)
+    {
+        int const face_count = static_cast<int>(faces.size());
+        std::vector<std::array<int, 3u>> face_keys(faces.size());
+        std::vector<std::uint64_t> face_hashes(faces.size());
+        igl::parallel_for(
+            face_count,
+            [&](int f) {
+                int const t = faces[f] / 4;
+                int const j = faces[f] % 4;
+                std::array<int, 3u> key{T(t, (j + 1) % 4), T(t, (j + 2) % 4), T(t, (j + 3) % 4)};
+                std::sort(key.begin(), key.end());
+
+                face_keys[f]   = key;
+                face_hashes[f] = detail::hash_indices(key);
+            },
+            1000u);
+
+        // non-manifold faces keep the first neighbour found
+        detail::visit_equal_keys(face_keys, face_hashes, [&](int a, int b) {
+            int const i = faces[a];
+            int const j = faces[b];
+            if (adjacency_(i / 4, i % 4) < 0)
+                adjacency_(i / 4, i % 4) = j / 4;
+            if (adjacency_(j / 4, j % 4) < 0)
+                adjacency_(j / 4, j % 4) = i / 4;
+        });
+    }
+
+    void build_grid(Eigen::MatrixXd const& V, Eigen::MatrixXi const& T)
+    {
+        int const tetrahedron_count = static_cast<int>(T.rows());
+        if (tetrahedron_count == 0 || V.rows() == 0)
+            return;
+
+        int constexpr max_resolution    = 1 << 10;
+        min_                            = V.colwise().minCoeff();
+        max_                            = V.colwise().maxCoeff();
+        Eigen::RowVector3d const extent = max_ - min_;
+        cell_size_                      = std::max(
+            {std::cbrt(extent.prod() / tetrahedron_count),
+             extent.maxCoeff() / max_resolution,
+             1e-12});
+        for (int d = 0; d < 3; ++d)
+            resolution_[d] = std::clamp(
+                static_cast<int>(std::ceil(extent(d) / cell_size_)),
+                1,
+                max_resolution);
+
+        // (cell, tetrahedron) pairs of every cell overlapped by a tetrahedron's bounding box,
+        // sorted by cell into compressed rows
+        std::vector<entry_t> const pairs = detail::parallel_collect<entry_t>(
+            tetrahedron_count,
+            [&](int t, std::vector<entry_t>& items) { add_cells(V, T, t, items); });
+
+        std::vector<std::uint64_t> keys(pairs.size());
+        for (std::size_t i = 0u; i < pairs.size(); ++i)
+            keys[i] = pairs[i].first;
+        std::vector<int> const order = detail::parallel_argsort(keys);
+
+        std::size_t const cell_count =
+            static_cast<std::size_t>(resolution_[0]) * resolution_[1] * resolution_[2];
+        cell_offsets_.assign(cell_count + 1u, 0);
+        cell_tetrahedra_.resize(pairs.size());
+        for (std::size_t i = 0u; i < order.size(); ++i)
+        {
+            cell_tetrahedra_[i] = pairs[order[i]].second;
+            ++cell_offsets_[pairs[order[i]].first + 1u];
+        }
+        for (std::size_t k = 0u; k < cell_count; ++k)
+            cell_offsets_[k + 1u] += cell_offsets_[k];
+    }
+
+    // (cell, tetrahedron) pair of the grid
+    using entry_t = std::pair<std::uint64_t, int>;
+
+    /**
+     * @brief
+     * Appends the pairs of tetrahedron t and the grid cells overlapped by its bounding box, which
+     * are clamped to the grid
+     */
+    void add_cells(
+        Eigen::MatrixXd const& V,
+        Eigen::MatrixXi const& T,
+        int t,
+        std::vector<entry_t>& items) const
+    {
+        auto const cell = [&](double x, int d) {
+            double const c = std::floor((x - min_(d)) / cell_size_);
+            return static_cast<int>(std::clamp(c, 0., static_cast<double>(resolution_[d] - 1)));
+        };
+
+        Eigen::RowVector3d lower = V.row(T(t, 0));
+        Eigen::RowVector3d upper = lower;
+        for (int j = 1; j < 4; ++j)
+        {
+            lower = lower.cwiseMin(V.row(T(t, j)));
+            upper = upper.cwiseMax(V.row(T(t, j)));
+        }
+
+        for (int z = cell(lower(2), 2); z <= cell(upper(2), 2); ++z)
+            for (int y = cell(lower(1), 1); y <= cell(upper(1), 1); ++y)
+                for (int x = cell(lower(0), 0); x <= cell(upper(0), 0); ++x)
+                    items.push_back({cell_index(x, y, z), t});
+    }
+
+    std::size_t cell_index(int x, int y, int z) const
+    {
+        return (static_cast<std::size_t>(z) * resolution_[1] + y) * resolution_[0] + x;
+    }
+
+    Eigen::MatrixXi adjacency_{};
+
+    Eigen::RowVector3d min_{Eigen::RowVector3d::Zero()};
+    Eigen::RowVector3d max_{Eigen::RowVector3d::Zero()};
+    double cell_size_{1.};
+    std::array<int, 3u> resolution_{1, 1, 1};
+    std::vector<int> cell_offsets_{};
+    std::vector<int> cell_tetrahedra_{};
+};
+
+} // namespace geometry
+
+#endif // TET_CUT_POINT_LOCATION_HPP
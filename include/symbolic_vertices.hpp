@@ -0,0 +1,269 @@
+#ifndef TET_CUT_SYMBOLIC_VERTICES_HPP
+#define TET_CUT_SYMBOLIC_VERTICES_HPP
+
+#include "attribute_transfer.hpp"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <igl/parallel_for.h>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Vertices created by cuts in symbolic form, i.e. as the crossing of an edge (two parents and
+ * weights (1-t, t)) or of a face (three parents and barycentric coordinates), stored as arrays
+ * per component. Vertices are grouped into levels such that the parents of a level's vertices
+ * are original vertices or vertices of earlier levels, which lets every level be materialized in
+ * parallel.
+ */
+struct symbolic_vertices_t
+{
+    Eigen::VectorXi vertices{};
+    Eigen::Matrix<int, Eigen::Dynamic, 3> parents{};
+    Eigen::Matrix<double, Eigen::Dynamic, 3> weights{};
+
+    // vertices of level l are rows level_offsets[l],...,level_offsets[l+1]-1
+    std::vector<int> level_offsets{0};
+
+    int size() const { return static_cast<int>(vertices.size()); }
+    int level_count() const { return static_cast<int>(level_offsets.size()) - 1; }
+};
+
+/**
+ * @brief
+ * Groups the vertex sources recorded by the cutter into levels of independent vertices. The
+ * vertices of one cut_mesh call only have parents that existed before the call, such that they
+ * form a single level.
+ * @param sources Vertex sources in creation order
+ */
+symbolic_vertices_t make_symbolic_vertices(std::vector<vertex_source_t> const& sources)
+{
+    int const count = static_cast<int>(sources.size());
+
+    std::unordered_map<int, int> levels{};
+    levels.reserve(sources.size());
+    std::vector<int> source_levels(sources.size());
+    int level_count = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        int level = 0;
+        for (int const parent : sources[i].vertices)
+        {
+            auto const it = parent >= 0 ? levels.find(parent) : levels.end();
+            if (it != levels.end())
+                level = std::max(level, it->second + 1);
+        }
+        levels[sources[i].vertex] = level;
+        source_levels[i]          = level;
+        level_count               = std::max(level_count, level + 1);
+    }
+
+    symbolic_vertices_t symbolic{};
+    symbolic.level_offsets.assign(static_cast<std::size_t>(level_count) + 1u, 0);
+    for (int const level : source_levels)
+        ++symbolic.level_offsets[level + 1];
+    std::partial_sum(
+        symbolic.level_offsets.begin(),
+        symbolic.level_offsets.end(),
+        symbolic.level_offsets.begin());
+
+    symbolic.vertices.resize(count);
+    symbolic.parents.resize(count, 3);
+    symbolic.weights.resize(count, 3);
+
+    std::vector<int> next(symbolic.level_offsets.begin(), symbolic.level_offsets.end() - 1);
+    for (int i = 0; i < count; ++i)
+    {
+        int const row          = next[source_levels[i]]++;
+        symbolic.vertices(row) = sources[i].vertex;
+        for (int k = 0; k < 3; ++k)
+        {
+            symbolic.parents(row, k) = sources[i].vertices[k];
+            symbolic.weights(row, k) = sources[i].weights[k];
+        }
+    }
+
+    return symbolic;
+}
+
+/**
+ * @brief
+ * Computes the positions of all symbolic vertices from their parents, level by level, with the
+ * vertices of every level evaluated in parallel blocks. Since positions only depend on the
+ * parents, materializing again after the original vertices moved keeps the created vertices
+ * exactly where they were relative to their parents.
+ * @param symbolic Symbolic vertices
+ * @param V Vertex positions, grown to hold the symbolic vertices if necessary
+ */
+void materialize_vertices(symbolic_vertices_t const& symbolic, Eigen::MatrixXd& V)
+{
+    if (symbolic.size() == 0)
+        return;
+
+    Eigen::Index const vertex_count = symbolic.vertices.maxCoeff() + 1;
+    if (vertex_count > V.rows())
+        V.conservativeResize(vertex_count, Eigen::NoChange);
+
+    int constexpr block_size = 1 << 12;
+    for (int l = 0; l < symbolic.level_count(); ++l)
+    {
+        int const first = symbolic.level_offsets[l];
+        int const count = symbolic.level_offsets[l + 1] - first;
+        igl::parallel_for((count + block_size - 1) / block_size, [&](int b) {
+            int const begin = first + b * block_size;
+            int const end   = std::min(first + count, begin + block_size);
+            for (int i = begin; i < end; ++i)
+            {
+                Eigen::RowVector3d position = Eigen::RowVector3d::Zero();
+                for (int k = 0; k < 3; ++k)
+                {
+                    int const parent = symbolic.parents(i, k);
+                    if (parent >= 0)
+                        position += symbolic.weights(i, k) * V.row(parent);
+                }
+                V.row(symbolic.vertices(i)) = position;
+            }
+        });
+    }
+}
+
+/**
+ * @brief
+ * Merges the created vertices that have the same parents and weights within tolerance, e.g. the
+ * crossings of an edge shared by several cut tetrahedra, and removes the merged rows from V.
+ * Rows of T and the sources are remapped to the remaining vertices. Copies created by fracture
+ * share the parents and weights of the vertex they copy, but lie on the other side of the cut
+ * surface, such that they are never merged.
+ * @param V Vertex positions
+ * @param T Tetrahedra
+ * @param sources Vertex sources in creation order
+ * @param tolerance Largest difference of weights of merged vertices
+ * @return Old to new vertex index map
+ */
+Eigen::VectorXi deduplicate_vertices(
+    Eigen::MatrixXd& V,
+    Eigen::MatrixXi& T,
+    std::vector<vertex_source_t>& sources,
+    double tolerance = 1e-9)
+{
+    int const vertex_count = static_cast<int>(V.rows());
+    int const source_count = static_cast<int>(sources.size());
+
+    // canonical form of a source, with parents in increasing order
+    std::vector<vertex_source_t> canonical(sources.size());
+    igl::parallel_for(
+        source_count,
+        [&](int i) {
+            std::array<int, 3u> order{0, 1, 2};
+            auto const& source = sources[i];
+            std::sort(order.begin(), order.end(), [&](int a, int b) {
+                return source.vertices[a] < source.vertices[b];
+            });
+
+            canonical[i].vertex = source.vertex;
+            for (int k = 0; k < 3; ++k)
+            {
+                canonical[i].vertices[k] = source.vertices[order[k]];
+                canonical[i].weights[k]  = source.vertices[order[k]] >= 0 ?
+                                               source.weights[order[k]] :
+                                               0.;
+            }
+        },
+        1000u);
+
+    // fracture copies keep their own rows
+    std::vector<int> order{};
+    order.reserve(sources.size());
+    for (int i = 0; i < source_count; ++i)
+        if (!sources[i].is_copy())
+            order.push_back(i);
+    int const mergeable_count = static_cast<int>(order.size());
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        auto const& sa = canonical[a];
+        auto const& sb = canonical[b];
+        if (sa.vertices != sb.vertices)
+            return sa.vertices < sb.vertices;
+        if (sa.weights != sb.weights)
+            return sa.weights < sb.weights;
+        return sa.vertex < sb.vertex;
+    });
+
+    Eigen::VectorXi representative =
+        Eigen::VectorXi::LinSpaced(vertex_count, 0, vertex_count - 1);
+    std::vector<std::uint8_t> is_merged(sources.size(), 0u);
+    for (int i = 0; i < mergeable_count;)
+    {
+        auto const& first = canonical[order[i]];
+        int j             = i + 1;
+        for (; j < mergeable_count; ++j)
+        {
+            auto const& other = canonical[order[j]];
+            bool const is_duplicate =
+                other.vertices == first.vertices &&
+                std::abs(other.weights[0] - first.weights[0]) <= tolerance &&
+                std::abs(other.weights[1] - first.weights[1]) <= tolerance &&
+                std::abs(other.weights[2] - first.weights[2]) <= tolerance;
+            if (!is_duplicate)
+                break;
+
+            representative(other.vertex) = first.vertex;
+            is_merged[order[j]]          = 1u;
+        }
+        i = j;
+    }
+
+    Eigen::VectorXi map(vertex_count);
+    int next = 0;
+    for (int v = 0; v < vertex_count; ++v)
+    {
+        if (representative(v) != v)
+            continue;
+
+        map(v) = next;
+        if (next != v)
+            V.row(next) = V.row(v);
+        ++next;
+    }
+    for (int v = 0; v < vertex_count; ++v)
+        map(v) = map(representative(v));
+
+    V.conservativeResize(next, Eigen::NoChange);
+    igl::parallel_for(
+        T.rows(),
+        [&](Eigen::Index t) {
+            for (int j = 0; j < 4; ++j)
+                T(t, j) = map(T(t, j));
+        },
+        1000u);
+
+    std::vector<vertex_source_t> remaining{};
+    remaining.reserve(sources.size());
+    for (int i = 0; i < source_count; ++i)
+    {
+        if (is_merged[i] != 0u)
+            continue;
+
+        vertex_source_t source = sources[i];
+        source.vertex          = map(source.vertex);
+        if (source.is_copy())
+            source.copied_vertex = map(source.copied_vertex);
+        for (int& parent : source.vertices)
+            if (parent >= 0)
+                parent = map(parent);
+        remaining.push_back(source);
+    }
+    sources = std::move(remaining);
+
+    return map;
+}
+
+} // namespace geometry
+
+#endif // TET_CUT_SYMBOLIC_VERTICES_HPP
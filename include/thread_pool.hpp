@@ -0,0 +1,174 @@
+#ifndef TET_CUT_THREAD_POOL_HPP
+#define TET_CUT_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace geometry {
+
+/**
+ * @brief
+ * Fixed set of worker threads executing batches of indexed tasks. Each worker owns a queue of
+ * task indices which it consumes from the back, and idle workers steal tasks from the front of
+ * the other workers' queues, such that uneven task costs are balanced.
+ */
+class work_stealing_thread_pool_t
+{
+  public:
+    explicit work_stealing_thread_pool_t(
+        std::size_t thread_count = std::max(1u, std::thread::hardware_concurrency()))
+    {
+        thread_count = std::max<std::size_t>(thread_count, 1u);
+        for (std::size_t i = 0; i < thread_count; ++i)
+            queues_.push_back(std::make_unique<queue_t>());
+
+        for (std::size_t i = 0; i < thread_count; ++i)
+            threads_.emplace_back([this, i]() { work(i); });
+    }
+
+    work_stealing_thread_pool_t(work_stealing_thread_pool_t const&) = delete;
+    work_stealing_thread_pool_t& operator=(work_stealing_thread_pool_t const&) = delete;
+
+    ~work_stealing_thread_pool_t()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            is_stopped_ = true;
+        }
+        start_.notify_all();
+        for (auto& thread : threads_)
+            thread.join();
+    }
+
+    std::size_t thread_count() const { return threads_.size(); }
+
+    /**
+     * @brief
+     * Executes task(i, worker) for i in [0,n) and blocks until all tasks have completed. Tasks
+     * are initially distributed in contiguous blocks over the workers' queues. The first
+     * exception thrown by a task is rethrown once all tasks have completed.
+     * @param n Number of tasks
+     * @param task Callable taking the task index and the index of the executing worker
+     */
+    void run(std::size_t n, std::function<void(std::size_t, std::size_t)> task)
+    {
+        if (n == 0u)
+            return;
+
+        std::size_t const worker_count = threads_.size();
+        std::size_t const block_size   = (n + worker_count - 1u) / worker_count;
+        for (std::size_t w = 0; w < worker_count; ++w)
+        {
+            std::lock_guard<std::mutex> lock{queues_[w]->mutex};
+            std::size_t const begin = std::min(n, w * block_size);
+            std::size_t const end   = std::min(n, begin + block_size);
+            for (std::size_t i = begin; i < end; ++i)
+                queues_[w]->tasks.push_back(i);
+        }
+
+        std::unique_lock<std::mutex> lock{mutex_};
+        task_         = std::move(task);
+        exception_    = nullptr;
+        busy_workers_ = worker_count;
+        ++generation_;
+        start_.notify_all();
+        done_.wait(lock, [this]() { return busy_workers_ == 0u; });
+        task_ = nullptr;
+
+        if (exception_)
+            std::rethrow_exception(exception_);
+    }
+
+  private:
+    struct queue_t
+    {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    bool pop(std::size_t worker, std::size_t& task)
+    {
+        auto& queue = *queues_[worker];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        if (queue.tasks.empty())
+            return false;
+
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(std::size_t worker, std::size_t& task)
+    {
+        for (std::size_t i = 1; i < queues_.size(); ++i)
+        {
+            auto& queue = *queues_[(worker + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock{queue.mutex};
+            if (queue.tasks.empty())
+                continue;
+
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    void work(std::size_t worker)
+    {
+        std::size_t generation = 0u;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock{mutex_};
+                start_.wait(lock, [&]() { return is_stopped_ || generation_ != generation; });
+                if (is_stopped_)
+                    return;
+                generation = generation_;
+            }
+
+            std::size_t task{};
+            while (pop(worker, task) || steal(worker, task))
+            {
+                try
+                {
+                    task_(task, worker);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock{mutex_};
+                    if (!exception_)
+                        exception_ = std::current_exception();
+                }
+            }
+
+            std::lock_guard<std::mutex> lock{mutex_};
+            if (--busy_workers_ == 0u)
+                done_.notify_all();
+        }
+    }
+
+    std::vector<std::unique_ptr<queue_t>> queues_{};
+    std::vector<std::thread> threads_{};
+
+    std::mutex mutex_{};
+    std::condition_variable start_{};
+    std::condition_variable done_{};
+    std::function<void(std::size_t, std::size_t)> task_{};
+    std::exception_ptr exception_{};
+    std::size_t generation_{0u};
+    std::size_t busy_workers_{0u};
+    bool is_stopped_{false};
+};
+
+} // namespace geometry
+
+#endif // TET_CUT_THREAD_POOL_HPP
@@ -0,0 +1,334 @@
+#ifndef TET_CUT_VERSIONED_MESH_HPP
+#define TET_CUT_VERSIONED_MESH_HPP
+
+#include "mesh_storage.hpp"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <igl/parallel_for.h>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+namespace detail {
+
+int constexpr mesh_page_row_count = 1 << 10;
+
+template <class Row>
+using mesh_page_t = std::array<Row, mesh_page_row_count>;
+
+/**
+ * @brief
+ * Rows stored in fixed size pages, such that versions of an array share the pages they did not
+ * modify
+ */
+template <class Row>
+struct paged_rows_t
+{
+    std::vector<std::shared_ptr<mesh_page_t<Row>>> pages{};
+    int size{0};
+
+    Row const& operator[](int i) const
+    {
+        return (*pages[i / mesh_page_row_count])[i % mesh_page_row_count];
+    }
+};
+
+/**
+ * @brief
+ * Copy-on-write access to paged rows. Pages shared with published versions are copied before
+ * their first write, while pages copied or created since the last publish are written in place.
+ */
+template <class Row>
+class paged_rows_writer_t
+{
+  public:
+    paged_rows_writer_t() = default;
+    explicit paged_rows_writer_t(paged_rows_t<Row> rows)
+        : rows_{std::move(rows)}, is_owned_(rows_.pages.size(), 1u)
+    {
+    }
+
+    paged_rows_t<Row> const& rows() const { return rows_; }
+    int size() const { return rows_.size; }
+
+    Row& row(int i)
+    {
+        std::size_t const p = static_cast<std::size_t>(i / mesh_page_row_count);
+        if (is_owned_[p] == 0u)
+        {
+            rows_.pages[p] = std::make_shared<mesh_page_t<Row>>(*rows_.pages[p]);
+            is_owned_[p]   = 1u;
+            ++copied_page_count_;
+        }
+        return (*rows_.pages[p])[i % mesh_page_row_count];
+    }
+
+    void grow(int size)
+    {
+        while (static_cast<int>(rows_.pages.size()) * mesh_page_row_count < size)
+        {
+            rows_.pages.push_back(std::make_shared<mesh_page_t<Row>>());
+            is_owned_.push_back(1u);
+        }
+        rows_.size = std::max(rows_.size, size);
+    }
+
+    /**
+     * @brief
+     * Shares all pages with the returned version, which must not be modified anymore
+     */
+    paged_rows_t<Row> publish()
+    {
+        std::fill(is_owned_.begin(), is_owned_.end(), 0u);
+        return rows_;
+    }
+
+    // number of shared pages copied before their first write
+    std::int64_t copied_page_count() const { return copied_page_count_; }
+
+  private:
+    paged_rows_t<Row> rows_{};
+    std::vector<std::uint8_t> is_owned_{};
+    std::int64_t copied_page_count_{0};
+};
+
+} // namespace detail
+
+/**
+ * @brief
+ * Immutable version of a versioned_mesh_t. Its pages are shared with the other versions that
+ * did not modify them, and are released along with the last version referring to them.
+ */
+class mesh_snapshot_t
+{
+  public:
+    using vertex_t      = std::array<double, 3u>;
+    using tetrahedron_t = std::array<int, 4u>;
+
+    mesh_snapshot_t(
+        detail::paged_rows_t<vertex_t> vertices,
+        detail::paged_rows_t<tetrahedron_t> tetrahedra,
+        std::uint64_t epoch)
+        : vertices_{std::move(vertices)}, tetrahedra_{std::move(tetrahedra)}, epoch_{epoch}
+    {
+    }
+
+    std::uint64_t epoch() const { return epoch_; }
+
+    int vertex_count() const { return vertices_.size; }
+    int tetrahedron_count() const { return tetrahedra_.size; }
+
+    Eigen::RowVector3d vertex(int v) const
+    {
+        auto const& position = vertices_[v];
+        return {position[0], position[1], position[2]};
+    }
+
+    Eigen::RowVector4i tetrahedron(int t) const
+    {
+        auto const& tetrahedron = tetrahedra_[t];
+        return {tetrahedron[0], tetrahedron[1], tetrahedron[2], tetrahedron[3]};
+    }
+
+    /**
+     * @brief
+     * Copies the snapshot into Eigen matrices, one page per parallel task
+     * @param V Vertex positions
+     * @param T Tetrahedra
+     */
+    void copy_to(Eigen::MatrixXd& V, Eigen::MatrixXi& T) const
+    {
+        V.resize(vertex_count(), 3);
+        T.resize(tetrahedron_count(), 4);
+        copy_rows(vertices_, V);
+        copy_rows(tetrahedra_, T);
+    }
+
+  private:
+    template <class Row, class Matrix>
+    static void copy_rows(detail::paged_rows_t<Row> const& rows, Matrix& M)
+    {
+        int const page_count = (rows.size + detail::mesh_page_row_count - 1) /
+                               detail::mesh_page_row_count;
+        igl::parallel_for(page_count, [&](int p) {
+            int const begin = p * detail::mesh_page_row_count;
+            int const end   = std::min(rows.size, begin + detail::mesh_page_row_count);
+            for (int i = begin; i < end; ++i)
+                for (int j = 0; j < static_cast<int>(M.cols()); ++j)
+                    M(i, j) = rows[i][static_cast<std::size_t>(j)];
+        });
+    }
+
+    detail::paged_rows_t<vertex_t> vertices_;
+    detail::paged_rows_t<tetrahedron_t> tetrahedra_;
+    std::uint64_t epoch_;
+};
+
+/**
+ * @brief
+ * Mesh modified by one thread, e.g. a cutter running cut_mesh through mesh_traits, and read by
+ * any number of threads, e.g. renderer, collision detection and solver, without locks around
+ * the cuts. Readers pin the latest published version with pin(), which only copies a shared
+ * pointer, and see consistent vertices and tetrahedra for as long as they hold it, regardless
+ * of the modifications made meanwhile. Everything but pin() must be called by the writing
+ * thread.
+ *
+ * Rows are stored in pages of detail::mesh_page_row_count rows. Modifications copy the pages
+ * they write on first write, or write into new pages, and become visible to readers only when
+ * publish() atomically replaces the latest version, at the cost of copying the page table. Cuts
+ * are local, so the pages copied by a cut are few compared to the mesh. A version and the pages
+ * only it refers to are reclaimed once the last reader holding it releases it.
+ *
+ * pin() and publish() exchange the latest version with the atomic shared_ptr functions, which
+ * libstdc++ and libc++ implement with a small pool of mutexes selected by address rather than
+ * lock-free. Readers are therefore not wait-free: a pin() can briefly wait for a concurrent
+ * publish() or for another pin() hashed to the same mutex, though only for the copy of one
+ * pointer, never for the duration of a cut.
+ */
+class versioned_mesh_t
+{
+  public:
+    /**
+     * @brief
+     * Publishes (V,T) as epoch 0
+     * @param V Vertex positions
+     * @param T Tetrahedra
+     */
+    versioned_mesh_t(Eigen::MatrixXd const& V, Eigen::MatrixXi const& T)
+    {
+        vertices_.grow(static_cast<int>(V.rows()));
+        tetrahedra_.grow(static_cast<int>(T.rows()));
+        igl::parallel_for(
+            V.rows(),
+            [&](Eigen::Index v) {
+                vertices_.row(static_cast<int>(v)) = {V(v, 0), V(v, 1), V(v, 2)};
+            },
+            1000u);
+        igl::parallel_for(
+            T.rows(),
+            [&](Eigen::Index t) {
+                tetrahedra_.row(static_cast<int>(t)) = {T(t, 0), T(t, 1), T(t, 2), T(t, 3)};
+            },
+            1000u);
+        publish();
+    }
+
+    versioned_mesh_t(versioned_mesh_t const&) = delete;
+    versioned_mesh_t& operator=(versioned_mesh_t const&) = delete;
+
+    /**
+     * @brief
+     * Latest published version, safe to call from any thread concurrently with modifications
+     * and publish(), which it may briefly wait for
+     */
+    std::shared_ptr<mesh_snapshot_t const> pin() const { return std::atomic_load(&latest_); }
+
+    /**
+     * @brief
+     * Makes the modifications since the last publish visible to readers
+     * @return Epoch of the published version
+     */
+    std::uint64_t publish()
+    {
+        auto snapshot = std::make_shared<mesh_snapshot_t const>(
+            vertices_.publish(),
+            tetrahedra_.publish(),
+            epoch_);
+        published_.erase(
+            std::remove_if(
+                published_.begin(),
+                published_.end(),
+                [](auto const& version) { return version.expired(); }),
+            published_.end());
+        published_.push_back(snapshot);
+        std::atomic_store(&latest_, std::shared_ptr<mesh_snapshot_t const>{std::move(snapshot)});
+        return epoch_++;
+    }
+
+    /**
+     * @brief
+     * Smallest epoch of the versions that are published and not yet reclaimed, i.e. the latest
+     * one or one still pinned by a reader. Must be called by the writing thread, since it reads
+     * the list of published versions that publish() modifies without synchronization. Readers
+     * releasing versions meanwhile only make the result conservative.
+     */
+    std::uint64_t oldest_pinned_epoch() const
+    {
+        std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+        for (auto const& version : published_)
+            if (auto const snapshot = version.lock())
+                oldest = std::min(oldest, snapshot->epoch());
+        return oldest;
+    }
+
+    // number of pages copied before their first write since construction
+    std::int64_t copied_page_count() const
+    {
+        return vertices_.copied_page_count() + tetrahedra_.copied_page_count();
+    }
+
+  private:
+    friend struct mesh_traits<versioned_mesh_t>;
+
+    detail::paged_rows_writer_t<mesh_snapshot_t::vertex_t> vertices_{};
+    detail::paged_rows_writer_t<mesh_snapshot_t::tetrahedron_t> tetrahedra_{};
+    std::uint64_t epoch_{0u};
+
+    std::shared_ptr<mesh_snapshot_t const> latest_{};
+    std::vector<std::weak_ptr<mesh_snapshot_t const>> published_{};
+};
+
+/**
+ * @brief
+ * Modifications of the unpublished version of a versioned mesh
+ */
+template <>
+struct mesh_traits<versioned_mesh_t>
+{
+    static int vertex_count(versioned_mesh_t const& mesh) { return mesh.vertices_.size(); }
+    static int tetrahedron_count(versioned_mesh_t const& mesh)
+    {
+        return mesh.tetrahedra_.size();
+    }
+
+    static Eigen::RowVector3d vertex(versioned_mesh_t const& mesh, int v)
+    {
+        auto const& position = mesh.vertices_.rows()[v];
+        return {position[0], position[1], position[2]};
+    }
+
+    static void set_vertex(versioned_mesh_t& mesh, int v, Eigen::RowVector3d const& position)
+    {
+        mesh.vertices_.row(v) = {position(0), position(1), position(2)};
+    }
+
+    static Eigen::RowVector4i tetrahedron(versioned_mesh_t const& mesh, int t)
+    {
+        auto const& tetrahedron = mesh.tetrahedra_.rows()[t];
+        return {tetrahedron[0], tetrahedron[1], tetrahedron[2], tetrahedron[3]};
+    }
+
+    static void
+    set_tetrahedron(versioned_mesh_t& mesh, int t, Eigen::RowVector4i const& tetrahedron)
+    {
+        mesh.tetrahedra_.row(t) = {tetrahedron(0), tetrahedron(1), tetrahedron(2), tetrahedron(3)};
+    }
+
+    static bool append(versioned_mesh_t& mesh, int vertex_count, int tetrahedron_count)
+    {
+        mesh.vertices_.grow(mesh.vertices_.size() + vertex_count);
+        mesh.tetrahedra_.grow(mesh.tetrahedra_.size() + tetrahedron_count);
+        return true;
+    }
+};
+
+} // namespace geometry
+
+#endif // TET_CUT_VERSIONED_MESH_HPP
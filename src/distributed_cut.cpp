@@ -0,0 +1,82 @@
+#include "distributed_cut.hpp"
+#include "mesh_io.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+/**
+ * @brief
+ * Cuts a mesh read from a Gmsh .msh file by the triangle (a,b,c) with one partition of the mesh
+ * per MPI process, and writes the gathered result, which is identical to a single process cut.
+ *
+ * Usage: mpirun -np N tet-cut-distributed <input.msh> <output.msh> ax ay az bx by bz cx cy cz
+ */
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+
+    int rank = 0, size = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (argc < 12)
+    {
+        if (rank == 0)
+            std::cerr << "Usage: mpirun -np N tet-cut-distributed <input.msh> <output.msh> ax ay "
+                         "az bx by bz cx cy cz\n";
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    Eigen::Vector3d a, b, c;
+    for (int d = 0; d < 3; ++d)
+    {
+        a(d) = std::stod(argv[3 + d]);
+        b(d) = std::stod(argv[6 + d]);
+        c(d) = std::stod(argv[9 + d]);
+    }
+
+    Eigen::MatrixXd V{};
+    Eigen::MatrixXi T{};
+    int is_read = rank == 0 ? geometry::read_msh(argv[1], V, T) : 0;
+    MPI_Bcast(&is_read, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (is_read == 0)
+    {
+        if (rank == 0)
+            std::cerr << "Could not read mesh " << argv[1] << "\n";
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    auto const begin = std::chrono::steady_clock::now();
+    auto partition   = geometry::scatter_mesh(MPI_COMM_WORLD, V, T);
+
+    // the root only needs its partition until the result is gathered
+    V.resize(0, 3);
+    T.resize(0, 4);
+
+    geometry::tetrahedron_mesh_cutter_t cutter{};
+    int const cut_count = geometry::cut_mesh(MPI_COMM_WORLD, cutter, partition, {a, b}, {a, c});
+
+    geometry::gather_mesh(MPI_COMM_WORLD, partition, V, T);
+    auto const end = std::chrono::steady_clock::now();
+
+    int status = EXIT_SUCCESS;
+    if (rank == 0)
+    {
+        std::cout << cut_count << " tetrahedra cut by " << size << " processes in "
+                  << std::chrono::duration<double>(end - begin).count() << " s, " << V.rows()
+                  << " vertices, " << T.rows() << " tetrahedra\n";
+
+        if (!geometry::write_msh(argv[2], V, T, true))
+        {
+            std::cerr << "Could not write mesh " << argv[2] << "\n";
+            status = EXIT_FAILURE;
+        }
+    }
+
+    MPI_Finalize();
+    return status;
+}
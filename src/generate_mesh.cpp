@@ -0,0 +1,54 @@
+#include "mesh_generation.hpp"
+#include "mesh_io.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+/**
+ * @brief
+ * Generates a Kuhn-subdivided cube grid of the unit cube with about the requested number of
+ * tetrahedra, optionally jitters its interior vertices, and writes it to a binary Gmsh .msh file
+ * or to TetGen .node and .ele files.
+ *
+ * Usage: tet-cut-generate <mesh.msh | mesh.node mesh.ele> <tetrahedra> [jitter amplitude] [seed]
+ */
+int main(int argc, char** argv)
+{
+    std::string const path = argc > 1 ? argv[1] : "";
+    bool const is_tetgen   = path.size() >= 5u && path.substr(path.size() - 5u) == ".node";
+    int const arg_offset   = is_tetgen ? 1 : 0;
+    if (argc < 3 + arg_offset)
+    {
+        std::cerr << "Usage: tet-cut-generate <mesh.msh | mesh.node mesh.ele> <tetrahedra> "
+                     "[jitter amplitude] [seed]\n";
+        return EXIT_FAILURE;
+    }
+
+    int const n              = geometry::cube_grid_resolution(std::stod(argv[2 + arg_offset]));
+    double const amplitude   = argc > 3 + arg_offset ? std::stod(argv[3 + arg_offset]) : 0.;
+    std::uint64_t const seed = argc > 4 + arg_offset ? std::stoull(argv[4 + arg_offset]) : 0u;
+
+    Eigen::MatrixXd V{};
+    Eigen::MatrixXi T{};
+    auto const begin = std::chrono::steady_clock::now();
+    geometry::generate_cube_grid(n, n, n, Eigen::Vector3d::Zero(), Eigen::Vector3d::Ones(), V, T);
+    if (amplitude > 0.)
+        geometry::jitter_vertices(V, Eigen::Vector3d::Constant(1. / n), amplitude, seed);
+    auto const end = std::chrono::steady_clock::now();
+
+    std::cout << V.rows() << " vertices, " << T.rows() << " tetrahedra generated in "
+              << std::chrono::duration<double>(end - begin).count() << " s\n";
+
+    bool const is_written = is_tetgen ? geometry::write_tetgen(path, argv[2], V, T) :
+                                        geometry::write_msh(path, V, T, true);
+    if (!is_written)
+    {
+        std::cerr << "Could not write mesh " << path << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
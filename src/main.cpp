@@ -1,6 +1,10 @@
+#include "async_cut.hpp"
 #include "cut_tetrahedron.hpp"
 
 #include <Eigen/Geometry>
+#include <chrono>
+#include <exception>
+#include <future>
 #include <glfw/glfw3.h>
 #include <igl/barycenter.h>
 #include <igl/boundary_facets.h>
@@ -9,6 +13,8 @@
 #include <igl/opengl/glfw/imgui/ImGuiMenu.h>
 #include <igl/trackball.h>
 #include <iomanip>
+#include <iostream>
+#include <memory>
 #include <sstream>
 
 int main(int argc, char** argv)
@@ -37,11 +43,18 @@ int main(int argc, char** argv)
         return std::make_pair(V, T);
     };
 
+    // cuts run in the background and are shown once their mesh is published
+    std::unique_ptr<geometry::async_mesh_cutter_t> async_cutter{};
+    std::future<geometry::async_cut_result_t> pending_cut{};
+
     auto const reset_demo = [&]() {
         auto pair = get_single_tetrahedron();
         V         = pair.first;
         T         = pair.second;
 
+        pending_cut  = {};
+        async_cutter = std::make_unique<geometry::async_mesh_cutter_t>(V, T);
+
         F = Eigen::MatrixXi(4u, 3u);
 
         igl::boundary_facets(T, F);
@@ -247,6 +260,32 @@ int main(int argc, char** argv)
 
         static bool is_cut{false};
 
+        if (pending_cut.valid() &&
+            pending_cut.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            try
+            {
+                pending_cut.get();
+
+                auto const buffer = async_cutter->front();
+                V                 = buffer->V;
+                T                 = buffer->T;
+                F                 = buffer->F;
+
+                is_cut = true;
+
+                viewer.data().clear();
+                viewer.data().set_mesh(V, F);
+                viewer.data().set_face_based(true);
+                viewer.data().show_lines = true;
+            }
+            catch (std::exception const& e)
+            {
+                // the published mesh is left as it was before the failed cut
+                std::cerr << "Cut failed: " << e.what() << "\n";
+            }
+        }
+
         // coordinate frame visualization
         viewer.data().add_edges(
             0.5 * Eigen::RowVector3d{0., 0., 0.},
@@ -356,22 +395,9 @@ int main(int argc, char** argv)
 
         if (ImGui::Button("Cut", ImVec2((w - p) / 2.f, 0.f)))
         {
-            geometry::cut_tetrahedron(
-                V,
-                T,
-                0,
+            pending_cut = async_cutter->submit(
                 {start_line_segment_p1, start_line_segment_p2},
                 {end_line_segment_p1, end_line_segment_p2});
-
-            igl::boundary_facets(T, F);
-            F = F.rowwise().reverse().eval();
-
-            is_cut = true;
-
-            viewer.data().clear();
-            viewer.data().set_mesh(V, F);
-            viewer.data().set_face_based(true);
-            viewer.data().show_lines = true;
         }
         if (ImGui::Button("Reset", ImVec2((w - p) / 2.f, 0.f)))
         {
@@ -0,0 +1,202 @@
+#include "batch_cut.hpp"
+#include "mesh_generation.hpp"
+#include "parallel_cut.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+// peak resident set size of the process in KiB, or -1 if unavailable
+long peak_resident_kib()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return -1;
+#endif
+}
+
+/**
+ * @brief
+ * Scaling benchmark of the cut path. For every mesh size, the mesh consists of block_count
+ * independent grids of the unit cube, each a jittered Kuhn cube grid with its share of the
+ * tetrahedra, which are cut concurrently by the batch cutter with the same cutting triangle
+ * covering a square of side cutter_scale across the cube. The same cut is applied to a single
+ * grid of the unit cube by the parallel cutter, in unordered and deterministic mode.
+ * Mesh size, cutter size and thread count are swept, and one CSV row is written per mode and
+ * repetition with the cut time, the number of cut and created tetrahedra and vertices, the mesh
+ * memory after the cut, and the process' peak resident memory. The overhead of the deterministic
+ * mode over the unordered mode, in mean cut time, is reported for every configuration.
+ *
+ * Usage: tet-cut-scaling [output.csv] [max tetrahedra] [repetitions] [jitter amplitude]
+ */
+int main(int argc, char** argv)
+{
+    std::string const path         = argc > 1 ? argv[1] : "scaling.csv";
+    double const max_tetrahedra    = argc > 2 ? std::stod(argv[2]) : 1e6;
+    int const repetitions          = argc > 3 ? std::stoi(argv[3]) : 3;
+    double const amplitude         = argc > 4 ? std::stod(argv[4]) : 0.1;
+    unsigned int const max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::ofstream csv{path};
+    if (!csv)
+    {
+        std::cerr << "Could not open " << path << "\n";
+        return EXIT_FAILURE;
+    }
+    csv << "mode,tetrahedra,blocks,cutter_scale,threads,repetition,seconds,cut_tetrahedra,"
+           "created_tetrahedra,created_vertices,mesh_bytes,peak_rss_kib\n";
+
+    std::vector<double> sizes{};
+    for (double size : {1e3, 1e4, 1e5, 1e6, 1e7, 5e7})
+        if (size <= max_tetrahedra)
+            sizes.push_back(size);
+
+    std::vector<unsigned int> thread_counts{};
+    for (unsigned int threads = 1u; threads < max_threads; threads *= 2u)
+        thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    Eigen::Vector3d const center{0.5013, 0.4987, 0.5031};
+    Eigen::Vector3d const u{1., 0., 0.1};
+    Eigen::Vector3d const w{0., 1., -0.07};
+
+    for (double const size : sizes)
+    {
+        int const block_count = std::clamp(static_cast<int>(size / 1e4), 1, 64);
+        int const n           = geometry::cube_grid_resolution(size / block_count);
+
+        // every block spans the whole unit cube, such that the cut crosses all of them
+        std::vector<Eigen::MatrixXd> block_V(static_cast<std::size_t>(block_count));
+        std::vector<Eigen::MatrixXi> block_T(static_cast<std::size_t>(block_count));
+        for (int b = 0; b < block_count; ++b)
+        {
+            geometry::generate_cube_grid(
+                n,
+                n,
+                n,
+                Eigen::Vector3d::Zero(),
+                Eigen::Vector3d::Ones(),
+                block_V[b],
+                block_T[b]);
+            geometry::jitter_vertices(
+                block_V[b],
+                Eigen::Vector3d::Constant(1. / n),
+                amplitude,
+                static_cast<std::uint64_t>(b));
+        }
+
+        // single mesh of the whole cube for the parallel cutter
+        int const grid_n = geometry::cube_grid_resolution(size);
+        Eigen::MatrixXd grid_V{};
+        Eigen::MatrixXi grid_T{};
+        geometry::generate_cube_grid(
+            grid_n,
+            grid_n,
+            grid_n,
+            Eigen::Vector3d::Zero(),
+            Eigen::Vector3d::Ones(),
+            grid_V,
+            grid_T);
+        geometry::jitter_vertices(grid_V, Eigen::Vector3d::Constant(1. / grid_n), amplitude);
+
+        long long const tetrahedron_count = static_cast<long long>(block_count) * 6 * n * n * n;
+        std::cout << "mesh of " << tetrahedron_count << " tetrahedra in " << block_count
+                  << " blocks\n";
+
+        for (unsigned int const threads : thread_counts)
+        {
+            geometry::batch_mesh_cutter_t cutter{threads};
+            geometry::parallel_mesh_cutter_t parallel_cutter{threads};
+
+            for (double const scale : {0.25, 0.5, 1.})
+            {
+                Eigen::Vector3d const a = center - 0.5 * scale * (u + w);
+                std::pair<Eigen::Vector3d, Eigen::Vector3d> const start_line{a, a + 2. * scale * u};
+                std::pair<Eigen::Vector3d, Eigen::Vector3d> const end_line{a, a + 2. * scale * w};
+
+                for (int repetition = 0; repetition < repetitions; ++repetition)
+                {
+                    std::vector<Eigen::MatrixXd> V = block_V;
+                    std::vector<Eigen::MatrixXi> T = block_T;
+
+                    std::vector<geometry::cut_job_t> jobs{};
+                    for (int b = 0; b < block_count; ++b)
+                        jobs.push_back({&V[b], &T[b], start_line, end_line});
+
+                    auto const begin   = std::chrono::steady_clock::now();
+                    auto const results = cutter.cut(jobs);
+                    auto const end     = std::chrono::steady_clock::now();
+
+                    geometry::cut_job_result_t total{};
+                    std::size_t mesh_bytes = 0u;
+                    for (int b = 0; b < block_count; ++b)
+                    {
+                        total.cut_tetrahedron_count += results[b].cut_tetrahedron_count;
+                        total.new_tetrahedron_count += results[b].new_tetrahedron_count;
+                        total.new_vertex_count += results[b].new_vertex_count;
+                        mesh_bytes += static_cast<std::size_t>(V[b].size()) * sizeof(double) +
+                                      static_cast<std::size_t>(T[b].size()) * sizeof(int);
+                    }
+
+                    csv << "batch," << tetrahedron_count << "," << block_count << "," << scale
+                        << "," << threads << "," << repetition << ","
+                        << std::chrono::duration<double>(end - begin).count() << ","
+                        << total.cut_tetrahedron_count << "," << total.new_tetrahedron_count
+                        << "," << total.new_vertex_count << "," << mesh_bytes << ","
+                        << peak_resident_kib() << "\n";
+                }
+
+                double mean_seconds[2]{0., 0.};
+                for (bool const deterministic : {false, true})
+                {
+                    parallel_cutter.deterministic = deterministic;
+                    for (int repetition = 0; repetition < repetitions; ++repetition)
+                    {
+                        Eigen::MatrixXd V = grid_V;
+                        Eigen::MatrixXi T = grid_T;
+
+                        auto const begin    = std::chrono::steady_clock::now();
+                        int const cut_count = parallel_cutter.cut(V, T, start_line, end_line);
+                        auto const end      = std::chrono::steady_clock::now();
+
+                        double const seconds = std::chrono::duration<double>(end - begin).count();
+                        mean_seconds[deterministic] += seconds / repetitions;
+
+                        std::size_t const mesh_bytes =
+                            static_cast<std::size_t>(V.size()) * sizeof(double) +
+                            static_cast<std::size_t>(T.size()) * sizeof(int);
+                        csv << (deterministic ? "deterministic," : "unordered,") << grid_T.rows()
+                            << ",1," << scale << "," << threads << "," << repetition << ","
+                            << seconds << "," << cut_count << "," << T.rows() - grid_T.rows()
+                            << "," << V.rows() - grid_V.rows() << "," << mesh_bytes << ","
+                            << peak_resident_kib() << "\n";
+                    }
+                }
+
+                std::cout << "  " << threads << " threads, cutter scale " << scale
+                          << ": deterministic mode overhead "
+                          << 100. * (mean_seconds[1] / mean_seconds[0] - 1.) << " %\n";
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
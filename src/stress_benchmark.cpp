@@ -0,0 +1,173 @@
+#include "cut_tetrahedron.hpp"
+
+#include <Eigen/Geometry>
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+
+struct mask_statistics_t
+{
+    int cut_count{0};
+    int unsupported_count{0};
+    int volume_violation_count{0};
+    int orientation_violation_count{0};
+    int plane_violation_count{0};
+};
+
+/**
+ * @brief
+ * Randomized stress test of the subdivision cases. Random positively oriented tetrahedra are cut
+ * by random triangles, and every cut is checked against the following oracles:
+ * - the children's volumes sum to the parent's volume
+ * - every child is positively oriented
+ * - every new vertex lies on the plane of the cutting triangle
+ *
+ * Usage: tet-cut-stress [seed] [iterations] [snapping tolerance]
+ */
+int main(int argc, char** argv)
+{
+    unsigned int const seed = argc > 1 ? static_cast<unsigned int>(std::stoul(argv[1])) : 0u;
+    int const iterations    = argc > 2 ? std::stoi(argv[2]) : 1'000'000;
+    double const tolerance  = argc > 3 ? std::stod(argv[3]) : 0.;
+
+    std::mt19937 generator{seed};
+    std::uniform_real_distribution<double> vertex_distribution{-1., 1.};
+    std::uniform_real_distribution<double> cutter_distribution{-1.5, 1.5};
+
+    geometry::tetrahedron_mesh_cutter_t cutter{};
+    cutter.snapping.enabled            = tolerance > 0.;
+    cutter.snapping.relative_tolerance = tolerance;
+
+    // masks with a subdivision case, found by subdividing a scratch tetrahedron
+    std::map<int, bool> is_supported{};
+    for (int mask = 1; mask < 64; ++mask)
+    {
+        Eigen::MatrixXd V = Eigen::MatrixXd::Identity(4, 3);
+        Eigen::MatrixXi T(1, 4);
+        T.row(0) = Eigen::RowVector4i{0, 1, 2, 3};
+        is_supported[mask] =
+            cutter.subdivide_mesh(std::byte{static_cast<unsigned char>(mask)}, V, T, 0, {}, {});
+    }
+
+    std::map<int, mask_statistics_t> statistics{};
+    double cut_seconds              = 0.;
+    long long created_tetrahedra    = 0;
+    double const relative_tolerance = 1e-9;
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        Eigen::MatrixXd V(4, 3);
+        Eigen::MatrixXi T(1, 4);
+        T.row(0) = Eigen::RowVector4i{0, 1, 2, 3};
+        for (int r = 0; r < 4; ++r)
+            for (int c = 0; c < 3; ++c)
+                V(r, c) = vertex_distribution(generator);
+
+        double volume = geometry::signed_volume(V, T, 0);
+        if (volume < 0.)
+        {
+            std::swap(T(0, 0), T(0, 1));
+            volume = -volume;
+        }
+
+        Eigen::Vector3d a, b, c;
+        for (int d = 0; d < 3; ++d)
+        {
+            a(d) = cutter_distribution(generator);
+            b(d) = cutter_distribution(generator);
+            c(d) = cutter_distribution(generator);
+        }
+
+        auto const mask = geometry::get_edge_intersections(
+                              V.row(T(0, 0)).transpose(),
+                              V.row(T(0, 1)).transpose(),
+                              V.row(T(0, 2)).transpose(),
+                              V.row(T(0, 3)).transpose(),
+                              a,
+                              b,
+                              c)
+                              .first;
+        if (mask == std::byte{0b00000000})
+            continue;
+
+        auto& mask_statistics = statistics[std::to_integer<int>(mask)];
+
+        int const vertex_count = static_cast<int>(V.rows());
+        auto const begin       = std::chrono::steady_clock::now();
+        bool const is_cut      = geometry::cut_tetrahedron(cutter, V, T, 0, {a, b}, {a, c});
+        auto const end         = std::chrono::steady_clock::now();
+        cut_seconds += std::chrono::duration<double>(end - begin).count();
+
+        if (!is_cut)
+        {
+            ++mask_statistics.unsupported_count;
+            continue;
+        }
+
+        ++mask_statistics.cut_count;
+        created_tetrahedra += T.rows() - 1;
+
+        double volume_sum           = 0.;
+        bool is_positively_oriented = true;
+        for (int t = 0; t < T.rows(); ++t)
+        {
+            double const child_volume = geometry::signed_volume(V, T, t);
+            volume_sum += child_volume;
+            is_positively_oriented = is_positively_oriented && child_volume > 0.;
+        }
+        if (std::abs(volume_sum - volume) > relative_tolerance * volume)
+            ++mask_statistics.volume_violation_count;
+        if (!is_positively_oriented)
+            ++mask_statistics.orientation_violation_count;
+
+        Eigen::Vector3d const n = (b - a).cross(c - a).normalized();
+        for (int v = vertex_count; v < V.rows(); ++v)
+        {
+            double const distance = std::abs(n.dot(V.row(v).transpose() - a));
+            if (distance > relative_tolerance * 10.)
+            {
+                ++mask_statistics.plane_violation_count;
+                break;
+            }
+        }
+    }
+
+    int total_cuts       = 0;
+    int total_violations = 0;
+    std::cout << std::setw(8) << "mask" << std::setw(12) << "cuts" << std::setw(14) << "unsupported"
+              << std::setw(10) << "volume" << std::setw(13) << "orientation" << std::setw(8)
+              << "plane" << "\n";
+    for (auto const& [mask, s] : statistics)
+    {
+        total_cuts += s.cut_count;
+        total_violations +=
+            s.volume_violation_count + s.orientation_violation_count + s.plane_violation_count;
+        std::cout << std::setw(8) << std::bitset<6u>(static_cast<unsigned long>(mask))
+                  << std::setw(12) << s.cut_count << std::setw(14) << s.unsupported_count
+                  << std::setw(10) << s.volume_violation_count << std::setw(13)
+                  << s.orientation_violation_count << std::setw(8) << s.plane_violation_count
+                  << "\n";
+    }
+
+    for (auto const& [mask, supported] : is_supported)
+    {
+        if (supported && statistics[mask].cut_count == 0)
+        {
+            std::cout << "supported mask " << std::bitset<6u>(static_cast<unsigned long>(mask))
+                      << " was not covered\n";
+        }
+    }
+
+    std::cout << "cuts: " << total_cuts << ", violations: " << total_violations << "\n";
+    std::cout << "throughput: " << static_cast<double>(total_cuts) / cut_seconds
+              << " cuts/s, " << static_cast<double>(created_tetrahedra) / cut_seconds
+              << " tetrahedra/s\n";
+
+    return total_violations == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,69 @@
+#include "mesh_io.hpp"
+#include "mesh_validation.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+/**
+ * @brief
+ * Checks the conformity of a tetrahedral mesh read from a Gmsh .msh file or TetGen .node and .ele
+ * files, and prints the violations found with their tetrahedron and vertex indices.
+ *
+ * Usage: tet-cut-validate <mesh.msh | mesh.node mesh.ele> [max reported violations]
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: tet-cut-validate <mesh.msh | mesh.node mesh.ele> "
+                     "[max reported violations]\n";
+        return EXIT_FAILURE;
+    }
+
+    std::string const path = argv[1];
+    bool const is_tetgen   = path.size() >= 5u && path.substr(path.size() - 5u) == ".node";
+    int const arg_offset   = is_tetgen ? 1 : 0;
+    std::size_t const max_reported =
+        argc > 2 + arg_offset ? std::stoul(argv[2 + arg_offset]) : std::size_t{10u};
+
+    Eigen::MatrixXd V{};
+    Eigen::MatrixXi T{};
+    bool const is_read = is_tetgen ? argc > 2 && geometry::read_tetgen(path, argv[2], V, T) :
+                                     geometry::read_msh(path, V, T);
+    if (!is_read)
+    {
+        std::cerr << "Could not read mesh " << path << "\n";
+        return EXIT_FAILURE;
+    }
+
+    auto const begin  = std::chrono::steady_clock::now();
+    auto const report = geometry::validate_conformity(V, T);
+    auto const end    = std::chrono::steady_clock::now();
+
+    std::cout << V.rows() << " vertices, " << T.rows() << " tetrahedra validated in "
+              << std::chrono::duration<double>(end - begin).count() << " s\n";
+
+    auto const print = [&](char const* name, auto const& violations, auto const& format) {
+        std::cout << name << ": " << violations.size() << "\n";
+        for (std::size_t i = 0u; i < std::min(max_reported, violations.size()); ++i)
+            std::cout << "  " << format(violations[i]) << "\n";
+    };
+    auto const tetrahedron = [](int t) { return "tetrahedron " + std::to_string(t); };
+    auto const tetrahedra  = [](std::pair<int, int> const& pair) {
+        return "tetrahedra " + std::to_string(pair.first) + ", " + std::to_string(pair.second);
+    };
+    auto const vertex = [](std::pair<int, int> const& pair) {
+        return "vertex " + std::to_string(pair.first) + " on tetrahedron " +
+               std::to_string(pair.second);
+    };
+
+    print("inverted tetrahedra", report.inverted_tetrahedra, tetrahedron);
+    print("duplicate tetrahedra", report.duplicate_tetrahedra, tetrahedra);
+    print("inconsistently oriented faces", report.inconsistently_oriented_faces, tetrahedra);
+    print("non-manifold faces", report.non_manifold_faces, tetrahedron);
+    print("hanging vertices", report.hanging_vertices, vertex);
+
+    return report.is_conforming() ? EXIT_SUCCESS : EXIT_FAILURE;
+}